@@ -146,6 +146,9 @@ static void print_help() {
 			"  {0}+t,  --tty_off       {2}force (OFF) tty mode\n"
 			"  {0}-p,  --preset <id>   {2}start with preset, integer value between 0-9\n"
 			"  {0}-u,  --update <ms>   {2}set the program update rate in milliseconds\n"
+			"  {0}     --pid <list>    {2}(Linux) only collect these comma separated pids and their descendants\n"
+			"  {0}     --pgrep <regex> {2}(Linux) only collect processes with matching names and their descendants\n"
+			"  {0}     --cgroup <path> {2}(Linux) only show processes, cpu and memory usage of a cgroup v2 group\n"
 			"  {0}     --utf-force     {2}force start even if no UTF-8 locale was detected\n"
 			"  {0}     --debug         {2}start in DEBUG mode: shows microsecond timer for information collect\n"
 			"  {0}                     {2}and screen draw functions and sets loglevel to DEBUG",
@@ -218,6 +221,35 @@ void argumentParser(const int argc, char **argv) {
 				exit(1);
 			}
 		}
+		else if (is_in(argument, "--pid", "--pgrep")) {
+			if (++i >= argc) {
+				fmt::println("{0}error:{1} {2} option needs an argument\n", "\033[1;31m", "\033[0m", argument);
+				print_usage();
+				print_help_hint();
+				exit(1);
+			}
+			const string value = argv[i];
+			const bool valid = (argument == "--pid"
+				? not value.empty() and std::ranges::all_of(ssplit(value, ','), [](const string& pid) { return isint(pid); })
+				: not s_contains(value, " ") and not s_contains(value, ",") and not isint(value) and Config::stringValid("proc_watch", value));
+			if (not valid) {
+				fmt::println("{0}error:{1} Invalid {2} value '{3}'\n", "\033[1;31m", "\033[0m", argument, value);
+				print_usage();
+				print_help_hint();
+				exit(1);
+			}
+			const string& current = Config::getS("watch_arg");
+			Config::set("watch_arg", (current.empty() ? "" : current + " ") + s_replace(value, ",", " "));
+		}
+		else if (argument == "--cgroup") {
+			if (++i >= argc) {
+				fmt::println("{0}error:{1} Cgroup option needs an argument\n", "\033[1;31m", "\033[0m");
+				print_usage();
+				print_help_hint();
+				exit(1);
+			}
+			Config::set("cgroup_arg", string(argv[i]));
+		}
 		else if (argument == "--utf-force")
 			Global::utf_force = true;
 		else if (argument == "--debug")
@@ -1201,8 +1233,13 @@ int main(int argc, char **argv) {
 				else if (future_time - current_time > update_ms) {
 					future_time = current_time;
 				}
+				//? Run proc filter change held back while typing, once the runner is done with the last one
+				else if (Input::filter_pending and not Runner::active) {
+					Input::filter_pending = false;
+					Runner::run("proc", true, true);
+				}
 				//? Poll for input and process any input detected
-				else if (Input::poll(min((uint64_t)1000, future_time - current_time))) {
+				else if (Input::poll(min((uint64_t)(Input::filter_pending ? 10 : 1000), future_time - current_time))) {
 					if (not Runner::active) Config::unlock();
 
 					if (Menu::active) Menu::process(Input::get());
@@ -20,6 +20,7 @@ tab-size = 4
 #include <atomic>
 #include <fstream>
 #include <ranges>
+#include <regex>
 #include <string_view>
 #include <utility>
 
@@ -64,7 +65,7 @@ namespace Config {
 								"#* Example: \"cpu:0:default,mem:0:tty,proc:1:default cpu:0:braille,proc:0:tty\""},
 
 		{"vim_keys",			"#* Set to True to enable \"h,j,k,l,g,G\" keys for directional control in lists.\n"
-								"#* Conflicting keys for h:\"help\" and k:\"kill\" is accessible while holding shift."},
+								"#* Conflicting keys for h:\"help\" and k:\"kill\" is accessible while holding shift, thread view is toggled with T instead of H."},
 
 		{"rounded_corners",		"#* Rounded corners on boxes, is ignored if TTY mode is ON."},
 
@@ -89,12 +90,26 @@ namespace Config {
 		{"update_ms", 			"#* Update time in milliseconds, recommended 2000 ms or above for better sample times for graphs."},
 
 		{"proc_sorting",		"#* Processes sorting, \"pid\" \"program\" \"arguments\" \"threads\" \"user\" \"memory\" \"cpu lazy\" \"cpu direct\",\n"
-								"#* \"cpu lazy\" sorts top process over time (easier to follow), \"cpu direct\" updates top process directly."},
+								"#* \"io read\" \"io write\" \"io total\" \"cpu wait\" \"cpu 1s\" \"cpu 10s\" \"cpu 60s\", \"cpu lazy\" sorts top process over time (easier to follow),\n"
+								"#* \"cpu direct\" updates top process directly, \"cpu 1s\" \"cpu 10s\" and \"cpu 60s\" sort on cpu usage averaged over that time.\n"
+								"#* The io values are disk read and write rates, (Linux) only available for processes of the same user unless running as root.\n"
+								"#* \"cpu wait\" is the time spent waiting for a cpu, (Linux) only available with proc_schedstat."},
+
+		{"proc_columns",		"#* Optional columns in the process list, separate values with whitespace. Available values are \"io_read\" \"io_write\" \"io_total\",\n"
+								"#* \"swap\" \"ctx_vol\" \"ctx_invol\" (voluntary and involuntary context switches of the main thread), \"fds\" (open files)\n"
+								"#* \"age\" (seconds since swap, context switches and fds were read, see proc_slow_budget)\n"
+								"#* \"wait\" (percent of time waiting for a cpu, see proc_schedstat) and \"cpu_1s\" \"cpu_10s\" \"cpu_60s\" (cpu usage\n"
+								"#* averaged over 1, 10 and 60 seconds with exponential decay, like load averages). Columns that don't fit in the width of the box are not shown."},
 
 		{"proc_reversed",		"#* Reverse sorting order, True or False."},
 
 		{"proc_tree",			"#* Show processes as a tree."},
 
+		{"proc_threads",		"#* (Linux) Show one row for each thread instead of each process, threads are shown below their process in tree view."},
+
+		{"proc_cgroups",		"#* (Linux) Show one row for each cgroup v2 group with the summed cpu, memory and threads of its processes,\n"
+								"#* together with memory.current, cpu throttling and oom kills of the cgroup. Parent cgroups are shown above their children in tree view."},
+
 		{"proc_colors", 		"#* Use the cpu graph colors in the process list."},
 
 		{"proc_gradient", 		"#* Use a darkening gradient in the process list."},
@@ -105,7 +120,8 @@ namespace Config {
 
 		{"proc_cpu_graphs",     "#* Show cpu graph for each process."},
 
-		{"proc_info_smaps",		"#* Use /proc/[pid]/smaps for memory information in the process info box (very slow but more accurate)"},
+		{"proc_info_smaps",		"#* Use /proc/[pid]/smaps for memory information in the process info box (very slow but more accurate),\n"
+								"#* (Linux) only used if /proc/[pid]/smaps_rollup isn't available, which is read by default and shows Pss, Uss and Swap."},
 
 		{"proc_left",			"#* Show proc box on left side of screen instead of right."},
 
@@ -113,6 +129,36 @@ namespace Config {
 
 		{"proc_aggregate",		"#* In tree-view, always accumulate child process resources in the parent process."},
 
+		{"proc_fd_cache",		"#* (Linux) Max number of /proc/[pid]/stat files kept open between updates, 0 to disable.\n"
+								"#* Will never use more than half of the open files limit (RLIMIT_NOFILE)."},
+
+		{"proc_collect_workers",	"#* (Linux) Number of threads used for reading process information, 0 for auto.\n"
+								"#* Auto adds one thread per 2048 processes, up to the number of cpu cores."},
+
+		{"proc_io_uring",		"#* (Linux) Read the cached /proc/[pid]/stat files in batches with io_uring, uses normal reads if io_uring is unavailable.\n"
+								"#* Only has an effect when proc_fd_cache is enabled. The kernel hands procfs reads to its own worker threads,\n"
+								"#* so this mostly helps on systems with many cores and can be slower than normal reads on small ones."},
+
+		{"proc_slow_budget",	"#* (Linux) Max number of processes per update that get swap, context switches and open files read for the\n"
+								"#* \"swap\" \"ctx_vol\" \"ctx_invol\" \"fds\" and \"age\" columns, processes that used cpu time are read first and the rest in turns."},
+
+		{"proc_watch",			"#* (Linux) Only collect the listed processes and their descendants, separate values with whitespace or commas.\n"
+								"#* Numbers are pids and other values are extended regular expressions matched against program names, like pgrep.\n"
+								"#* Only the watched processes are read each update, /proc is scanned every few seconds for new matching programs.\n"
+								"#* Overridden by the --pid and --pgrep options, empty to collect all processes."},
+
+		{"cgroup_scope",		"#* (Linux) Only collect processes in this cgroup v2 group and the groups below it, read from their cgroup.procs files.\n"
+								"#* The cpu box shows the usage in cpu.stat of the group, relative to cpu.max if limited, and the mem box memory.current\n"
+								"#* relative to memory.max. Paths can be given as in /proc/[pid]/cgroup or below the cgroup mount, e.g. \"/system.slice/nginx.service\".\n"
+								"#* Takes precedence over proc_watch, overridden by the --cgroup option, empty to show the whole system."},
+
+		{"proc_schedstat",		"#* (Linux) Calculate process cpu usage from the nanosecond process cpu clock instead of the 10 ms clock ticks\n"
+								"#* in /proc/[pid]/stat, more accurate with short update times. Also reads the time the main thread spent waiting\n"
+								"#* for a cpu from /proc/[pid]/schedstat, shown with the \"wait\" column. Reads one more file for each process."},
+
+		{"proc_events",			"#* (Linux) Listen to process events from the kernel to count processes that start and exit between updates.\n"
+								"#* Needs root or CAP_NET_ADMIN, shown as \"exited\" at the bottom of the proc box."},
+
 		{"cpu_graph_upper", 	"#* Sets the CPU stat shown in upper half of the CPU graph, \"total\" is always available.\n"
 								"#* Select from a list of detected attributes from the options menu."},
 
@@ -243,6 +289,11 @@ namespace Config {
 		{"net_iface", ""},
 		{"log_level", "WARNING"},
 		{"proc_filter", ""},
+		{"proc_columns", ""},
+		{"proc_watch", ""},
+		{"watch_arg", ""},
+		{"cgroup_scope", ""},
+		{"cgroup_arg", ""},
 		{"proc_command", ""},
 		{"selected_name", ""},
 	#ifdef GPU_SUPPORT
@@ -263,6 +314,8 @@ namespace Config {
 		{"rounded_corners", true},
 		{"proc_reversed", false},
 		{"proc_tree", false},
+		{"proc_threads", false},
+		{"proc_cgroups", false},
 		{"proc_colors", true},
 		{"proc_gradient", true},
 		{"proc_per_core", false},
@@ -304,6 +357,9 @@ namespace Config {
 		{"show_detailed", false},
 		{"proc_filtering", false},
 		{"proc_aggregate", false},
+		{"proc_events", false},
+		{"proc_schedstat", false},
+		{"proc_io_uring", false},
 	#ifdef GPU_SUPPORT
 		{"nvml_measure_pcie_speeds", true},
 		{"rsmi_measure_pcie_speeds", true},
@@ -321,7 +377,10 @@ namespace Config {
 		{"selected_depth", 0},
 		{"proc_start", 0},
 		{"proc_selected", 0},
-		{"proc_last_selected", 0}
+		{"proc_last_selected", 0},
+		{"proc_fd_cache", 16384},
+		{"proc_collect_workers", 0},
+		{"proc_slow_budget", 256}
 	};
 	std::unordered_map<std::string_view, int> intsTmp;
 
@@ -499,6 +558,15 @@ namespace Config {
 		else if (name == "update_ms" and i_value > ONE_DAY_MILLIS)
 			validError = fmt::format("Config value update_ms set too high (>{}).", ONE_DAY_MILLIS);
 
+		else if (name == "proc_fd_cache" and i_value < 0)
+			validError = "Config value proc_fd_cache can't be negative.";
+
+		else if (name == "proc_collect_workers" and (i_value < 0 or i_value > 256))
+			validError = "Config value proc_collect_workers needs to be between 0 and 256.";
+
+		else if (name == "proc_slow_budget" and i_value < 0)
+			validError = "Config value proc_slow_budget can't be negative.";
+
 		else
 			return true;
 
@@ -556,6 +624,26 @@ namespace Config {
 			}
 			return true;
 		}
+		else if (name == "proc_columns") {
+			for (const auto& column : ssplit(value)) {
+				if (not v_contains(Proc::column_vector, column)) {
+					validError = "Invalid column name in proc_columns: " + column;
+					return false;
+				}
+			}
+			return true;
+		}
+		else if (name == "proc_watch") {
+			for (const auto& token : ssplit(s_replace(value, ",", " "))) {
+				if (isint(token)) continue;
+				try { std::regex(token, std::regex::extended); }
+				catch (const std::regex_error&) {
+					validError = "Invalid pattern in proc_watch: " + token;
+					return false;
+				}
+			}
+			return true;
+		}
 		else if (name == "io_graph_speeds") {
 			const auto maps = ssplit(value);
 			bool all_good = true;
@@ -1471,8 +1471,8 @@ namespace Proc {
 	int selected_pid = 0, selected_depth = 0;
 	string selected_name;
 	std::unordered_map<size_t, Draw::Graph> p_graphs;
-	std::unordered_map<size_t, bool> p_wide_cmd;
 	std::unordered_map<size_t, int> p_counters;
+	const string pending_name = "…";
 	int counter = 0;
 	Draw::TextEdit filter;
 	Draw::Graph detailed_cpu_graph;
@@ -1480,6 +1480,39 @@ namespace Proc {
 	int user_size, thread_size, prog_size, cmd_size, tree_size;
 	int dgraph_x, dgraph_width, d_width, d_x, d_y;
 
+	//* Optional columns from config "proc_columns" that fit in the box, as indexes in Proc::column_vector
+	vector<size_t> columns;
+	constexpr int column_size = 6;
+	const array<string, 12> column_labels = { "IO/R:", "IO/W:", "IO/s:", "Swap:", "CtxV:", "CtxI:", "Fds:", "Age:", "Wait:", "C1s:", "C10s:", "C60s:" };
+
+	//* Shorten counts to fit in a column: 123456 -> 123K, 123456789 -> 123M
+	string short_count(uint64_t value) {
+		if (value >= 100'000'000) return to_string(value / 1'000'000) + 'M';
+		if (value >= 100'000) return to_string(value / 1'000) + 'K';
+		return to_string(value);
+	}
+
+	//* Percentages with one decimal below 100 to fit in a column
+	string short_percent(double value) {
+		return fmt::format("{:.{}f}%", value, (value < 100 ? 1 : 0));
+	}
+
+	string column_value(const proc_info& p, size_t column, double uptime) {
+		switch (column) {
+			case 0: return floating_humanizer(p.io_read, true);
+			case 1: return floating_humanizer(p.io_write, true);
+			case 2: return floating_humanizer(p.io_read + p.io_write, true);
+			case 3: return floating_humanizer(p.swap, true);
+			case 4: return short_count(p.ctx_vol);
+			case 5: return short_count(p.ctx_invol);
+			case 6: return (p.fds < 0 ? "-" : short_count(p.fds));
+			case 7: return (p.slow_time == 0.0 ? "-" : short_count(max(0.0, uptime - p.slow_time)) + 's');
+			case 8: return (p.sched_time == 0 ? "-" : short_percent(p.cpu_wait));
+			case 9: case 10: case 11: return (p.avg_time <= 0.0 ? "-" : short_percent(p.cpu_avg[column - 9]));
+			default: return "";
+		}
+	}
+
 	string box;
 
 	int selection(const string& cmd_key) {
@@ -1545,6 +1578,7 @@ namespace Proc {
 	string draw(const vector<proc_info>& plist, bool force_redraw, bool data_same) {
 		if (Runner::stopping) return "";
 		auto proc_tree = Config::getB("proc_tree");
+		auto proc_cgroups = Config::getB("proc_cgroups");
 		bool show_detailed = (Config::getB("show_detailed") and cmp_equal(Proc::detailed.last_pid, Config::getI("detailed_pid")));
 		bool proc_gradient = (Config::getB("proc_gradient") and not Config::getB("lowcolor") and Theme::gradients.contains("proc"));
 		auto proc_colors = Config::getB("proc_colors");
@@ -1586,6 +1620,16 @@ namespace Proc {
 				tree_size += 5;
 			}
 
+			//? Optional columns take space from the command or tree field while it stays readable
+			columns.clear();
+			for (const auto& column : ssplit(Config::getS("proc_columns"))) {
+				const auto index = v_index(column_vector, column);
+				if (index >= column_vector.size() or (proc_tree ? tree_size : cmd_size) < 20 + column_size + 1) continue;
+				columns.push_back(index);
+				cmd_size -= column_size + 1;
+				tree_size -= column_size + 1;
+			}
+
 			//? Detailed box
 			if (show_detailed) {
 				bool alive = detailed.status != "Dead";
@@ -1702,39 +1746,43 @@ namespace Proc {
 
 			//? select, info and signal buttons
 			const string down_button = (selected == select_max and start == numpids - select_max ? Theme::c("inactive_fg") : Theme::c("hi_fg")) + Symbols::down;
-			const string t_color = (selected == 0 ? Theme::c("inactive_fg") : Theme::c("title"));
-			const string hi_color = (selected == 0 ? Theme::c("inactive_fg") : Theme::c("hi_fg"));
+			//? Info and signals don't apply to the rows of cgroup view
+			const bool actions = (selected > 0 and not proc_cgroups);
+			const string t_color = (not actions ? Theme::c("inactive_fg") : Theme::c("title"));
+			const string hi_color = (not actions ? Theme::c("inactive_fg") : Theme::c("hi_fg"));
 			int mouse_x = x + 14;
-			out += Mv::to(y + height - 1, x + 1) + title_left_down + Fx::b + hi_color + Symbols::up + Theme::c("title") + " select " + down_button + Fx::ub + title_right_down
+			out += Mv::to(y + height - 1, x + 1) + title_left_down + Fx::b + (selected == 0 ? Theme::c("inactive_fg") : Theme::c("hi_fg")) + Symbols::up + Theme::c("title") + " select " + down_button + Fx::ub + title_right_down
 				+ title_left_down + Fx::b + t_color + "info " + hi_color + Symbols::enter + Fx::ub + title_right_down;
-				if (selected > 0) Input::mouse_mappings["enter"] = {y + height - 1, mouse_x, 1, 6};
+				if (actions) Input::mouse_mappings["enter"] = {y + height - 1, mouse_x, 1, 6};
 				mouse_x += 8;
 			if (width > 60) {
 				out += title_left_down + Fx::b + hi_color + 't' + t_color + "erminate" + Fx::ub + title_right_down;
-				if (selected > 0) Input::mouse_mappings["t"] = {y + height - 1, mouse_x, 1, 9};
+				if (actions) Input::mouse_mappings["t"] = {y + height - 1, mouse_x, 1, 9};
 				mouse_x += 11;
 			}
 			if (width > 55) {
 				out += title_left_down + Fx::b + hi_color + (vim_keys ? 'K' : 'k') + t_color + "ill" + Fx::ub + title_right_down;
-				if (selected > 0) Input::mouse_mappings["k"] = {y + height - 1, mouse_x, 1, 4};
+				if (actions) Input::mouse_mappings["k"] = {y + height - 1, mouse_x, 1, 4};
 				mouse_x += 6;
 			}
 			out += title_left_down + Fx::b + hi_color + 's' + t_color + "ignals" + Fx::ub + title_right_down;
-			if (selected > 0) Input::mouse_mappings["s"] = {y + height - 1, mouse_x, 1, 7};
+			if (actions) Input::mouse_mappings["s"] = {y + height - 1, mouse_x, 1, 7};
 
 			//? Labels for fields in list
 			if (not proc_tree)
 				out += Mv::to(y+1, x+1) + Theme::c("title") + Fx::b
-					+ rjust("Pid:", 8) + ' '
-					+ ljust("Program:", prog_size) + ' '
-					+ (cmd_size > 0 ? ljust("Command:", cmd_size) : "") + ' ';
+					+ rjust((proc_cgroups ? "Id:" : Config::getB("proc_threads") ? "Tid:" : "Pid:"), 8) + ' '
+					+ ljust((proc_cgroups ? "Cgroup:" : "Program:"), prog_size) + ' '
+					+ (cmd_size > 0 ? ljust((proc_cgroups ? "Path:" : "Command:"), cmd_size) : "") + ' ';
 			else
 				out += Mv::to(y+1, x+1) + Theme::c("title") + Fx::b
 					+ ljust("Tree:", tree_size) + ' ';
 
 			out += (thread_size > 0 ? Mv::l(4) + "Threads: " : "")
-					+ ljust("User:", user_size) + ' '
-					+ rjust((mem_bytes ? "MemB" : "Mem%"), 5) + ' '
+					+ ljust("User:", user_size) + ' ';
+			for (const auto column : columns)
+				out += rjust(column_labels.at(column), column_size) + ' ';
+			out += rjust((mem_bytes ? "MemB" : "Mem%"), 5) + ' '
 					+ rjust("Cpu%", (show_graphs ? 10 : 5)) + Fx::ub;
 		}
 		//* End of redraw block
@@ -1764,7 +1812,7 @@ namespace Proc {
 			if (item_fit >= 3) out += cjust(detailed.io_read, item_width);
 			if (item_fit >= 4) out += cjust(detailed.io_write, item_width);
 			if (item_fit >= 5) out += cjust(detailed.parent, item_width, true);
-			if (item_fit >= 6) out += cjust(detailed.entry.user, item_width, true);
+			if (item_fit >= 6) out += cjust(detailed.entry.user.str(), item_width, true);
 			if (item_fit >= 7) out += cjust(to_string(detailed.entry.threads), item_width);
 			if (item_fit >= 8) out += cjust(to_string(detailed.entry.p_nice), item_width);
 
@@ -1772,10 +1820,14 @@ namespace Proc {
 			const double mem_p = (double)detailed.mem_bytes.back() * 100 / totalMem;
 			string mem_str = to_string(mem_p);
 			mem_str.resize((mem_p < 10 or mem_p >= 100 ? 3 : 4));
-			out += Mv::to(d_y + 4, d_x + 1) + Theme::c("title") + Fx::b + rjust((item_fit > 4 ? "Memory: " : "M:") + mem_str + "% ", (d_width / 3) - 2)
+			out += Mv::to(d_y + 4, d_x + 1) + Theme::c("title") + Fx::b + rjust((not detailed.mem_details.empty() ? "Pss: " : item_fit > 4 ? "Memory: " : "M:") + mem_str + "% ", (d_width / 3) - 2)
 				+ Theme::c("inactive_fg") + Fx::ub + graph_bg * (d_width / 3) + Mv::l(d_width / 3)
 				+ Theme::c("proc_misc") + detailed_mem_graph(detailed.mem_bytes, (redraw or data_same or not alive)) + ' '
 				+ Theme::c("title") + Fx::b + detailed.memory;
+
+			//? Rss, Uss and Swap next to Pss if there is space left
+			if (const int details_width = d_width - (d_width / 3) * 2 - ulen(detailed.memory) - 1; not detailed.mem_details.empty() and details_width > 10)
+				out += ' ' + Theme::c("main_fg") + Fx::ub + ljust(detailed.mem_details, details_width - 1);
 		}
 
 		//? Check bounds of current selection and view
@@ -1790,9 +1842,12 @@ namespace Proc {
 
 		//* Iteration over processes
 		int lc = 0;
+		const double uptime = (v_contains(columns, v_index(column_vector, "age"s)) ? system_uptime() : 0.0);
 		for (int n=0; auto& p : plist) {
 			if (p.filtered or (proc_tree and p.tree_index == plist.size()) or n++ < start) continue;
 			bool is_selected = (lc + 1 == selected);
+			//? Name, command and user can be read after the process is first listed, show a placeholder until then
+			const string& p_name = (p.names_pending ? pending_name : p.name);
 			if (is_selected) {
 				selected_pid = (int)p.pid;
 				selected_name = p.name;
@@ -1848,14 +1903,12 @@ namespace Proc {
 				}
 			}
 
-			if (not p_wide_cmd.contains(p.pid)) p_wide_cmd[p.pid] = ulen(p.cmd) != ulen(p.cmd, true);
-
 			//? Normal view line
 			if (not proc_tree) {
 				out += Mv::to(y+2+lc, x+1)
 					+ g_color + rjust(to_string(p.pid), 8) + ' '
-					+ c_color + ljust(p.name, prog_size, true) + ' ' + end
-					+ (cmd_size > 0 ? g_color + ljust(p.cmd, cmd_size, true, p_wide_cmd[p.pid]) + Mv::to(y+2+lc, x+11+prog_size+cmd_size) + ' ' : "");
+					+ c_color + ljust(p_name, prog_size, true) + ' ' + end
+					+ (cmd_size > 0 ? g_color + ljust(p.cmd, cmd_size, true, p.cmd.wide()) + Mv::to(y+2+lc, x+11+prog_size+cmd_size) + ' ' : "");
 			}
 			//? Tree view line
 			else {
@@ -1864,13 +1917,13 @@ namespace Proc {
 				out += Mv::to(y+2+lc, x+1) + g_color + uresize(prefix_pid, width_left) + ' ';
 				width_left -= ulen(prefix_pid);
 				if (width_left > 0) {
-					out += c_color + uresize(p.name, width_left - 1) + end + ' ';
-					width_left -= (ulen(p.name) + 1);
+					out += c_color + uresize(p_name, width_left - 1) + end + ' ';
+					width_left -= (ulen(p_name) + 1);
 				}
 				if (width_left > 7) {
-					const string& cmd = width_left > 40 ? rtrim(p.cmd) : p.short_cmd;
+					const string& cmd = width_left > 40 ? rtrim(p.cmd) : p.short_cmd.str();
 					if (not cmd.empty() and cmd != p.name) {
-						out += g_color + '(' + uresize(cmd, width_left - 3, p_wide_cmd[p.pid]) + ") ";
+						out += g_color + '(' + uresize(cmd, width_left - 3, p.cmd.wide()) + ") ";
 						width_left -= (ulen(cmd, true) + 3);
 					}
 				}
@@ -1904,8 +1957,10 @@ namespace Proc {
 			}();
 
 			out += (thread_size > 0 ? t_color + rjust(proc_threads_string, thread_size) + ' ' + end : "" )
-				+ g_color + ljust((cmp_greater(p.user.size(), user_size) ? p.user.substr(0, user_size - 1) + '+' : p.user), user_size) + ' '
-				+ m_color + rjust(mem_str, 5) + end + ' '
+				+ g_color + ljust((cmp_greater(p.user.str().size(), user_size) ? p.user.str().substr(0, user_size - 1) + '+' : p.user.str()), user_size) + ' ';
+			for (const auto column : columns)
+				out += rjust(column_value(p, column, uptime), column_size) + ' ';
+			out += m_color + rjust(mem_str, 5) + end + ' '
 				+ (is_selected ? "" : Theme::c("inactive_fg")) + (show_graphs ? graph_bg * 5: "")
 				+ (p_graphs.contains(p.pid) ? Mv::l(5) + c_color + p_graphs.at(p.pid)({(p.cpu_p >= 0.1 and p.cpu_p < 5 ? 5ll : (long long)round(p.cpu_p))}, data_same) : "") + end + ' '
 				+ c_color + rjust(cpu_str, 4) + "  " + end;
@@ -1932,6 +1987,14 @@ namespace Proc {
 		out += Mv::to(y + height - 1, x+width - 3 - max(9, (int)location.size())) + Fx::ub + Theme::c("proc_box") + loc_clear
 			+ Symbols::title_left_down + Theme::c("title") + Fx::b + location + Fx::ub + Theme::c("proc_box") + Symbols::title_right_down;
 
+		//? Number and cpu usage of processes that started and exited since last update
+		if (Config::getB("proc_events") and width > 85) {
+			const string exited = fmt::format("exited {} {:.1f}%", transient.count, transient.cpu_p);
+			const int exited_len = max(17, (int)exited.size());
+			out += Mv::to(y + height - 1, x + width - 5 - max(9, (int)location.size()) - exited_len) + Symbols::h_line * (exited_len - exited.size())
+				+ Symbols::title_left_down + Theme::c("title") + Fx::b + exited + Fx::ub + Theme::c("proc_box") + Symbols::title_right_down;
+		}
+
 		//? Clear out left over graphs from dead processes at a regular interval
 		if (not data_same and ++counter >= 100) {
 			counter = 0;
@@ -1943,10 +2006,6 @@ namespace Proc {
 			std::erase_if(p_counters, [&](const auto& pair) {
 				return rng::find(plist, pair.first, &proc_info::pid) == plist.end();
 			});
-
-			std::erase_if(p_wide_cmd, [&](const auto& pair) {
-				return rng::find(plist, pair.first, &proc_info::pid) == plist.end();
-			});
 		}
 
 		if (selected == 0 and selected_pid != 0) {
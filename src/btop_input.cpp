@@ -86,6 +86,7 @@ namespace Input {
 	std::unordered_map<string, Mouse_loc> mouse_mappings;
 
 	deque<string> history(50, "");
+	bool filter_pending{};
 	string old_filter;
 	string input;
 
@@ -210,6 +211,7 @@ namespace Input {
 			auto vim_keys = Config::getB("vim_keys");
 			auto help_key = (vim_keys ? "H" : "h");
 			auto kill_key = (vim_keys ? "K" : "k");
+			auto thread_key = (vim_keys ? "T" : "H");
 			//? Global input actions
 			if (not filtering) {
 				bool keep_going = false;
@@ -299,6 +301,12 @@ namespace Input {
 					else if (Proc::filter.command(key)) {
 						if (Config::getS("proc_filter") != Proc::filter.text)
 							Config::set("proc_filter", Proc::filter.text);
+
+						//? Don't queue up a filter pass for every key while the last one is still being collected and drawn
+						if (Runner::active) {
+							filter_pending = true;
+							return;
+						}
 					}
 					else
 						return;
@@ -324,6 +332,20 @@ namespace Input {
 					Config::flip("proc_tree");
 					no_update = false;
 				}
+				else if (key == thread_key) {
+					Config::flip("proc_threads");
+					no_update = false;
+				}
+				else if (key == "v") {
+					Config::flip("proc_cgroups");
+					if (Config::getB("show_detailed")) {
+						Config::set("proc_selected", 0);
+						Config::set("proc_last_selected", 0);
+						Config::set("detailed_pid", 0);
+						Config::set("show_detailed", false);
+					}
+					no_update = false;
+				}
 
 				else if (key == "r")
 					Config::flip("proc_reversed");
@@ -382,7 +404,7 @@ namespace Input {
 					else
 						keep_going = true;
 				}
-				else if (key == "enter") {
+				else if (key == "enter" and not Config::getB("proc_cgroups")) {
 					if (Config::getI("proc_selected") == 0 and not Config::getB("show_detailed")) {
 						return;
 					}
@@ -406,13 +428,13 @@ namespace Input {
 					if (key == "-" or key == "space") Proc::collapse = pid;
 					no_update = false;
 				}
-				else if (is_in(key, "t", kill_key) and (Config::getB("show_detailed") or Config::getI("selected_pid") > 0)) {
+				else if (is_in(key, "t", kill_key) and not Config::getB("proc_cgroups") and (Config::getB("show_detailed") or Config::getI("selected_pid") > 0)) {
 					atomic_wait(Runner::active);
 					if (Config::getB("show_detailed") and Config::getI("proc_selected") == 0 and Proc::detailed.status == "Dead") return;
 					Menu::show(Menu::Menus::SignalSend, (key == "t" ? SIGTERM : SIGKILL));
 					return;
 				}
-				else if (key == "s" and (Config::getB("show_detailed") or Config::getI("selected_pid") > 0)) {
+				else if (key == "s" and not Config::getB("proc_cgroups") and (Config::getB("show_detailed") or Config::getI("selected_pid") > 0)) {
 					atomic_wait(Runner::active);
 					if (Config::getB("show_detailed") and Config::getI("proc_selected") == 0 and Proc::detailed.status == "Dead") return;
 					Menu::show(Menu::Menus::SignalChoose);
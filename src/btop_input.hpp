@@ -56,6 +56,9 @@ namespace Input {
 	//* Last entered key
 	extern deque<string> history;
 
+	//* Set when a proc filter change was held back while the runner was busy, run from the main loop when it's done
+	extern bool filter_pending;
+
 	//* Poll keyboard & mouse input for <timeout> ms and return input availability as a bool
 	bool poll(const uint64_t timeout=0);
 
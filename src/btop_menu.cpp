@@ -192,10 +192,13 @@ namespace Menu {
 		{"a", "Toggle auto scaling for the network graphs."},
 		{"y", "Toggle synced scaling mode for network graphs."},
 		{"f, /", "To enter a process filter. Start with ! for regex."},
+		{"", "Or use terms like user:root cpu>5 mem>1G !cmd:/re/"},
 		{"delete", "Clear any entered filter."},
 		{"c", "Toggle per-core cpu usage of processes."},
 		{"r", "Reverse sorting order in processes box."},
 		{"e", "Toggle processes tree view."},
+		{"H", "Toggle thread view, T with vim keys."},
+		{"v", "Toggle cgroup view."},
 		{"%", "Toggles memory display mode in processes box."},
 		{"Selected +, -", "Expand/collapse the selected process in tree view."},
 		{"Selected t", "Terminate selected process with SIGTERM - 15."},
@@ -250,7 +253,9 @@ namespace Menu {
 				"",
 				"Conflicting keys for",
 				"h (help) and k (kill)",
-				"is accessible while holding shift."},
+				"is accessible while holding shift.",
+				"",
+				"Thread view is toggled with T instead of H."},
 
 			{"presets",
 				"Define presets for the layout of the boxes.",
@@ -729,12 +734,38 @@ namespace Menu {
 				"",
 				"Possible values:",
 				"\"pid\", \"program\", \"arguments\", \"threads\",",
-				"\"user\", \"memory\", \"cpu lazy\" and",
-				"\"cpu direct\".",
+				"\"user\", \"memory\", \"cpu lazy\",",
+				"\"cpu direct\", \"io read\", \"io write\",",
+				"\"io total\", \"cpu wait\", \"cpu 1s\",",
+				"\"cpu 10s\" and \"cpu 60s\".",
 				"",
 				"\"cpu lazy\" updates top process over time.",
 				"\"cpu direct\" updates top process",
-				"directly."},
+				"directly.",
+				"",
+				"\"cpu 1s\", \"cpu 10s\" and \"cpu 60s\" sort",
+				"on cpu usage averaged over that time.",
+				"",
+				"Io is the disk read and write rate, only",
+				"for own processes unless running as root."},
+			{"proc_columns",
+				"Optional columns in process list.",
+				"",
+				"Separate values with whitespace.",
+				"",
+				"Available values:",
+				"\"io_read\", \"io_write\", \"io_total\",",
+				"\"swap\", \"ctx_vol\", \"ctx_invol\", \"fds\",",
+				"\"age\", \"wait\", \"cpu_1s\", \"cpu_10s\",",
+				"\"cpu_60s\".",
+				"",
+				"Swap, context switches and open files",
+				"are read for a limited number of",
+				"processes per update, age is seconds",
+				"since they were read.",
+				"",
+				"Columns that don't fit in the box",
+				"width are not shown."},
 			{"proc_reversed",
 				"Reverse processes sorting order.",
 				"",
@@ -745,6 +776,51 @@ namespace Menu {
 				"Set true to show processes grouped by",
 				"parents with lines drawn between parent",
 				"and child process."},
+			{"proc_threads",
+				"(Linux) Show threads instead of processes.",
+				"",
+				"Show one row for each thread with its own",
+				"name, state and cpu usage.",
+				"",
+				"Threads are shown below their process",
+				"in tree view."},
+			{"proc_cgroups",
+				"(Linux) Show cgroups instead of processes.",
+				"",
+				"Show one row for each cgroup v2 group",
+				"with summed cpu, memory and threads of",
+				"its processes, and memory.current, cpu",
+				"throttling and oom kills of the cgroup.",
+				"",
+				"Parent cgroups are shown above their",
+				"children in tree view."},
+			{"proc_watch",
+				"(Linux) Only collect watched processes.",
+				"",
+				"Pids and program name patterns separated",
+				"by whitespace or commas, the processes",
+				"and their descendants are collected.",
+				"",
+				"Patterns are extended regular expressions",
+				"matched like pgrep, new matches are found",
+				"by a full scan every few seconds.",
+				"",
+				"Set by --pid or --pgrep if given.",
+				"Empty to collect all processes."},
+			{"cgroup_scope",
+				"(Linux) Only show a cgroup v2 group.",
+				"",
+				"Processes are read from cgroup.procs of",
+				"the group and all groups below it.",
+				"",
+				"Cpu box shows cpu.stat usage relative to",
+				"cpu.max and mem box memory.current",
+				"relative to memory.max of the group.",
+				"",
+				"Example: \"/system.slice/nginx.service\"",
+				"",
+				"Set by --cgroup if given.",
+				"Empty to show the whole system."},
 			{"proc_aggregate",
 				"Aggregate child's resources in parent.",
 				"",
@@ -783,6 +859,26 @@ namespace Menu {
 				"",
 				"Set to 'True' to filter out internal",
 				"processes started by the Linux kernel."},
+			{"proc_events",
+				"(Linux) Track short lived processes.",
+				"",
+				"Listen to process events from the kernel",
+				"and show count and cpu usage of processes",
+				"that started and exited between updates.",
+				"",
+				"Needs root or CAP_NET_ADMIN."},
+			{"proc_schedstat",
+				"(Linux) Nanosecond process cpu usage.",
+				"",
+				"Calculate cpu usage from the process",
+				"cpu clock instead of clock ticks, more",
+				"accurate at short update times.",
+				"",
+				"Also reads time the main thread spent",
+				"waiting for a cpu from schedstat for",
+				"the \"wait\" column and sorting.",
+				"",
+				"Reads one more file for each process."},
 		}
 	};
 
@@ -1245,7 +1341,7 @@ namespace Menu {
 				const auto& option = categories[selected_cat][item_height * page + selected][0];
 				if (selPred.test(isString) and Config::stringValid(option, editor.text)) {
 					Config::set(option, editor.text);
-					if (option == "custom_cpu_name" or option.starts_with("custom_gpu_name"))
+					if (option == "custom_cpu_name" or option.starts_with("custom_gpu_name") or option == "proc_columns")
 						screen_redraw = true;
 					else if (is_in(option, "shown_boxes", "presets")) {
 						screen_redraw = true;
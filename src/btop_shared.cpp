@@ -16,9 +16,22 @@ indent = tab
 tab-size = 4
 */
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <numeric>
 #include <ranges>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 
 #include "btop_config.hpp"
 #include "btop_shared.hpp"
@@ -87,30 +100,262 @@ namespace Gpu {
 #endif
 
 namespace Proc {
-	void proc_sorter(vector<proc_info>& proc_vec, const string& sorting, bool reverse, bool tree) {
-		if (reverse) {
-			switch (v_index(sort_vector, sorting)) {
-			case 0: rng::stable_sort(proc_vec, rng::less{}, &proc_info::pid); 		break;
-			case 1: rng::stable_sort(proc_vec, rng::less{}, &proc_info::name);		break;
-			case 2: rng::stable_sort(proc_vec, rng::less{}, &proc_info::cmd); 		break;
-			case 3: rng::stable_sort(proc_vec, rng::less{}, &proc_info::threads);	break;
-			case 4: rng::stable_sort(proc_vec, rng::less{}, &proc_info::user);		break;
-			case 5: rng::stable_sort(proc_vec, rng::less{}, &proc_info::mem); 		break;
-			case 6: rng::stable_sort(proc_vec, rng::less{}, &proc_info::cpu_p);		break;
-			case 7: rng::stable_sort(proc_vec, rng::less{}, &proc_info::cpu_c);		break;
-			}
-		}
-		else {
-			switch (v_index(sort_vector, sorting)) {
-			case 0: rng::stable_sort(proc_vec, rng::greater{}, &proc_info::pid); 		break;
-			case 1: rng::stable_sort(proc_vec, rng::greater{}, &proc_info::name);		break;
-			case 2: rng::stable_sort(proc_vec, rng::greater{}, &proc_info::cmd); 		break;
-			case 3: rng::stable_sort(proc_vec, rng::greater{}, &proc_info::threads);	break;
-			case 4: rng::stable_sort(proc_vec, rng::greater{}, &proc_info::user); 		break;
-			case 5: rng::stable_sort(proc_vec, rng::greater{}, &proc_info::mem); 		break;
-			case 6: rng::stable_sort(proc_vec, rng::greater{}, &proc_info::cpu_p);   	break;
-			case 7: rng::stable_sort(proc_vec, rng::greater{}, &proc_info::cpu_c);   	break;
+	transient_info transient;
+
+	namespace {
+		//* Interned user names, names are kept in a deque so the views used as keys stay valid
+		struct user_table {
+			deque<string> names{""};
+			vector<uint32_t> ranks{0};
+			std::unordered_map<std::string_view, uint32_t> index{{"", 0}};
+			bool ranks_changed{};
+		};
+
+		user_table& users() {
+			static user_table table;
+			return table;
+		}
+	}
+
+	struct shared_string::entry {
+		string text;
+		size_t refs{};
+		int wide = -1;
+	};
+
+	namespace {
+		struct string_table {
+			std::mutex mtx;
+			std::unordered_map<std::string_view, shared_string::entry*> index;
+		};
+
+		string_table& strings() {
+			static string_table table;
+			return table;
+		}
+
+		const string empty_string{};
+	}
+
+	shared_string::shared_string(std::string_view text) {
+		if (text.empty()) return;
+		auto& table = strings();
+		std::lock_guard lock(table.mtx);
+		if (auto found = table.index.find(text); found != table.index.end()) {
+			ref = found->second;
+			ref->refs++;
+			return;
+		}
+		ref = new entry{string{text}, 1};
+		table.index.emplace(ref->text, ref);
+	}
+
+	shared_string::shared_string(const shared_string& other) : ref(other.ref) {
+		if (ref == nullptr) return;
+		std::lock_guard lock(strings().mtx);
+		ref->refs++;
+	}
+
+	shared_string& shared_string::operator=(const shared_string& other) {
+		if (ref != other.ref) {
+			shared_string copy{other};
+			std::swap(ref, copy.ref);
+		}
+		return *this;
+	}
+
+	shared_string& shared_string::operator=(shared_string&& other) noexcept {
+		if (this != &other) {
+			release();
+			ref = std::exchange(other.ref, nullptr);
+		}
+		return *this;
+	}
+
+	void shared_string::release() {
+		if (ref == nullptr) return;
+		auto& table = strings();
+		{
+			std::lock_guard lock(table.mtx);
+			if (--ref->refs > 0) {
+				ref = nullptr;
+				return;
+			}
+			table.index.erase(ref->text);
+		}
+		delete ref;
+		ref = nullptr;
+	}
+
+	const string& shared_string::str() const {
+		return ref == nullptr ? empty_string : ref->text;
+	}
+
+	bool shared_string::wide() const {
+		if (ref == nullptr) return false;
+		if (ref->wide < 0) ref->wide = (ulen(ref->text) != ulen(ref->text, true));
+		return ref->wide;
+	}
+
+	user_handle::user_handle(std::string_view name) {
+		auto& table = users();
+		if (auto found = table.index.find(name); found != table.index.end()) {
+			id = found->second;
+			return;
+		}
+		id = table.names.size();
+		table.index.emplace(table.names.emplace_back(name), id);
+		table.ranks.push_back(0);
+		table.ranks_changed = true;
+	}
+
+	const string& user_handle::str() const {
+		return users().names[id];
+	}
+
+	uint32_t user_handle::rank() const {
+		auto& table = users();
+		if (table.ranks_changed) {
+			vector<uint32_t> order(table.names.size());
+			std::iota(order.begin(), order.end(), 0);
+			rng::sort(order, rng::less{}, [&](uint32_t i) -> const string& { return table.names[i]; });
+			for (uint32_t n = 0; n < order.size(); n++) table.ranks[order[n]] = n;
+			table.ranks_changed = false;
+		}
+		return table.ranks[id];
+	}
+
+	//* Stable sort of [first, last) by merging the runs already in order, close to linear when the order from last update mostly holds
+	//* Returns false and leaves the range untouched if there are more than <max_runs> runs
+	template <typename It, typename Comp>
+	bool natural_merge_sort(It first, It last, Comp comp, size_t max_runs) {
+		static vector<size_t> runs;
+		const size_t size = last - first;
+		runs.assign(1, 0);
+		for (size_t i = 1; i < size; i++) {
+			if (comp(first[i], first[i - 1])) {
+				if (runs.size() >= max_runs) return false;
+				runs.push_back(i);
+			}
+		}
+		runs.push_back(size);
+
+		//? Merge pairs of neighbouring runs until only one is left
+		while (runs.size() > 2) {
+			size_t kept = 1, r = 0;
+			for (; r + 2 < runs.size(); r += 2) {
+				std::inplace_merge(first + runs[r], first + runs[r + 1], first + runs[r + 2], comp);
+				runs[kept++] = runs[r + 2];
 			}
+			if (r + 1 < runs.size()) runs[kept++] = runs[r + 1];
+			runs.resize(kept);
+		}
+		return true;
+	}
+
+	//* Sort <proc_vec> by the field selected by <proj>, keys are copied to a contiguous array together with their
+	//* original position and only that array is sorted, the entries are then moved into their final place in a single pass
+	//* If <limit> is set, only the first <limit> unfiltered entries are guaranteed to be in order, returns number of entries in order
+	template <typename Proj, typename Comp>
+	size_t permutation_sort(vector<proc_info>& proc_vec, Proj proj, Comp comp, size_t limit) {
+		using field_t = std::remove_cvref_t<std::invoke_result_t<Proj, const proc_info&>>;
+		using key_t = std::conditional_t<std::is_same_v<field_t, string>, std::string_view, field_t>;
+		using entry_t = std::pair<key_t, uint32_t>;
+		static vector<entry_t> keys;
+		static vector<proc_info> sorted;
+
+		const bool top_only = (limit > 0 and limit < proc_vec.size());
+
+		//? When only the top entries are needed, filtered out entries are put last and left unsorted
+		keys.clear();
+		keys.reserve(proc_vec.size());
+		for (uint32_t i = 0; i < proc_vec.size(); i++) {
+			if (not top_only or not proc_vec[i].filtered) keys.emplace_back(std::invoke(proj, proc_vec[i]), i);
+		}
+		const auto shown_end = keys.end() - keys.begin();
+		if (top_only) {
+			for (uint32_t i = 0; i < proc_vec.size(); i++) {
+				if (proc_vec[i].filtered) keys.emplace_back(std::invoke(proj, proc_vec[i]), i);
+			}
+		}
+
+		auto key_comp = [&comp](const entry_t& a, const entry_t& b) { return comp(a.first, b.first); };
+		size_t sorted_count = proc_vec.size();
+
+		//? Start from the order of last update, falling back to a partial or full sort if too much has changed
+		if (not natural_merge_sort(keys.begin(), keys.begin() + shown_end, key_comp, (top_only ? 32 : std::max((size_t)32, proc_vec.size() / 8)))) {
+			if (top_only and std::cmp_less(limit, shown_end)) {
+				//? partial_sort isn't stable, so equal keys are ordered by their previous position
+				std::partial_sort(keys.begin(), keys.begin() + limit, keys.begin() + shown_end, [&comp](const entry_t& a, const entry_t& b) {
+					return comp(a.first, b.first) or (not comp(b.first, a.first) and a.second < b.second);
+				});
+				sorted_count = limit;
+			}
+			else {
+				std::stable_sort(keys.begin(), keys.begin() + shown_end, key_comp);
+			}
+		}
+
+		//? Nothing to move if the order is unchanged
+		if (rng::all_of(keys, [i = (uint32_t)0](const entry_t& e) mutable { return e.second == i++; }))
+			return sorted_count;
+
+		sorted.clear();
+		sorted.reserve(proc_vec.size());
+		for (const auto& [key, i] : keys)
+			sorted.push_back(std::move(proc_vec[i]));
+		proc_vec.swap(sorted);
+		return sorted_count;
+	}
+
+	void update_cpu_avg(proc_info& p, double now) {
+		const double elapsed = now - p.avg_time;
+		if (p.avg_time == 0.0 or elapsed <= 0.0) {
+			if (p.avg_time == 0.0) p.avg_time = -now;
+			return;
+		}
+
+		//? A negative time marks the first sample, the averages start at the current usage instead of ramping up from zero
+		if (p.avg_time < 0.0) {
+			p.cpu_avg.fill(p.cpu_p);
+			p.avg_time = now;
+			return;
+		}
+
+		//? Most processes are sampled at the same interval, so the decay factors are only calculated when it changes
+		thread_local double last_elapsed{};
+		thread_local array<double, 3> factors{};
+		if (elapsed != last_elapsed) {
+			last_elapsed = elapsed;
+			for (size_t i = 0; i < factors.size(); i++) factors[i] = 1.0 - std::exp(-elapsed / cpu_avg_windows[i]);
+		}
+		for (size_t i = 0; i < factors.size(); i++) p.cpu_avg[i] += factors[i] * (p.cpu_p - p.cpu_avg[i]);
+		p.avg_time = now;
+	}
+
+	size_t proc_sorter(vector<proc_info>& proc_vec, const string& sorting, bool reverse, bool tree, size_t limit) {
+		size_t sorted_count = proc_vec.size();
+		auto sort_by = [&](auto proj) {
+			if (reverse) sorted_count = permutation_sort(proc_vec, proj, rng::less{}, (tree ? 0 : limit));
+			else sorted_count = permutation_sort(proc_vec, proj, rng::greater{}, (tree ? 0 : limit));
+		};
+
+		switch (v_index(sort_vector, sorting)) {
+		case 0: sort_by(&proc_info::pid); 		break;
+		case 1: sort_by(&proc_info::name);		break;
+		case 2: sort_by([](const proc_info& p) -> std::string_view { return p.cmd.str(); });	break;
+		case 3: sort_by(&proc_info::threads);	break;
+		case 4: sort_by([](const proc_info& p) { return p.user.rank(); });	break;
+		case 5: sort_by(&proc_info::mem); 		break;
+		case 6: sort_by(&proc_info::cpu_p);		break;
+		case 7: sort_by(&proc_info::cpu_c);		break;
+		case 8: sort_by(&proc_info::io_read);	break;
+		case 9: sort_by(&proc_info::io_write);	break;
+		case 10: sort_by([](const proc_info& p) { return p.io_read + p.io_write; });	break;
+		case 11: sort_by(&proc_info::cpu_wait);	break;
+		case 12: sort_by([](const proc_info& p) { return p.cpu_avg[0]; });	break;
+		case 13: sort_by([](const proc_info& p) { return p.cpu_avg[1]; });	break;
+		case 14: sort_by([](const proc_info& p) { return p.cpu_avg[2]; });	break;
 		}
 
 		//* When sorting with "cpu lazy" push processes over threshold cpu usage to the front regardless of cumulative usage
@@ -129,125 +374,427 @@ namespace Proc {
 				}
 			}
 		}
+		return sorted_count;
 	}
 
-	void tree_sort(vector<tree_proc>& proc_vec, const string& sorting, bool reverse, int& c_index, const int index_max, bool collapsed) {
-		if (proc_vec.size() > 1) {
-			if (reverse) {
-				switch (v_index(sort_vector, sorting)) {
-				case 3: rng::stable_sort(proc_vec, [](const auto& a, const auto& b) { return a.entry.get().threads < b.entry.get().threads; });	break;
-				case 5: rng::stable_sort(proc_vec, [](const auto& a, const auto& b) { return a.entry.get().mem < b.entry.get().mem; });	break;
-				case 6: rng::stable_sort(proc_vec, [](const auto& a, const auto& b) { return a.entry.get().cpu_p < b.entry.get().cpu_p; });	break;
-				case 7: rng::stable_sort(proc_vec, [](const auto& a, const auto& b) { return a.entry.get().cpu_c < b.entry.get().cpu_c; });	break;
+	namespace {
+		//* Case insensitive search for <needle> in <haystack>
+		bool contains_ic(std::string_view haystack, std::string_view needle) {
+			return std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+				[](unsigned char ch1, unsigned char ch2) { return std::toupper(ch1) == std::toupper(ch2); }) != haystack.end();
+		}
+
+		//* Parse a number with an optional K, M, G or T suffix (1024 based), returns false if not a valid number
+		bool parse_number(std::string_view text, double& out, bool with_unit) {
+			const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+			if (ec != std::errc{}) return false;
+			std::string_view unit{end, (size_t)(text.data() + text.size() - end)};
+			if (unit.empty()) return true;
+			if (not with_unit) return false;
+			if (unit.ends_with("iB")) unit.remove_suffix(2);
+			else if (unit.ends_with('B') and unit.size() > 1) unit.remove_suffix(1);
+			if (unit.size() != 1) return false;
+			const auto pos = std::string_view{"KMGT"}.find((char)std::toupper((unsigned char)unit.front()));
+			if (pos == std::string_view::npos) return false;
+			out *= std::pow(1024.0, pos + 1);
+			return true;
+		}
+	}
+
+	filter_query::filter_query(const string& filter) : filter(filter) {
+		static const std::array<std::pair<std::string_view, field>, 5> text_fields = {{
+			{"pid:", field::pid}, {"name:", field::name}, {"cmd:", field::cmd}, {"command:", field::cmd}, {"user:", field::user}
+		}};
+		static const std::array<std::pair<std::string_view, field>, 4> number_fields = {{
+			{"cpu", field::cpu}, {"mem", field::mem}, {"threads", field::threads}, {"pid", field::pid}
+		}};
+		static const std::array<std::pair<std::string_view, op>, 5> operators = {{
+			{"<=", op::less_equal}, {">=", op::greater_equal}, {"<", op::less}, {">", op::greater}, {"=", op::equal}
+		}};
+
+		auto make_regex = [](term& t, std::string_view pattern) {
+			try {
+				t.regex.emplace(pattern.begin(), pattern.end(), std::regex::extended);
+				t.compare = op::regex;
+				return true;
+			}
+			catch (const std::regex_error&) { return false; }
+		};
+
+		//? Parse one term, returns false if it isn't a field or numeric term
+		auto parse_term = [&](std::string_view token, term& t) {
+			if (token.starts_with('!') and token.size() > 1) {
+				t.negate = true;
+				token.remove_prefix(1);
+			}
+			for (const auto& [prefix, target] : text_fields) {
+				if (not token.starts_with(prefix)) continue;
+				t.target = target;
+				token.remove_prefix(prefix.size());
+				if (token.size() > 2 and token.starts_with('/') and token.ends_with('/'))
+					make_regex(t, token.substr(1, token.size() - 2));
+				else if (target == field::pid and parse_number(token, t.number, false))
+					t.compare = op::equal;
+				else
+					t.text = token;
+				return true;
+			}
+			for (const auto& [name, target] : number_fields) {
+				if (not token.starts_with(name)) continue;
+				for (const auto& [symbol, compare] : operators) {
+					if (token.substr(name.size()).starts_with(symbol)) {
+						t.target = target;
+						t.compare = compare;
+						if (not parse_number(token.substr(name.size() + symbol.size()), t.number, target == field::mem))
+							t.text = token;
+						return true;
+					}
 				}
 			}
+			return false;
+		};
+
+		vector<term> parsed;
+		bool qualified = false;
+		for (const auto& part : ssplit(filter)) {
+			auto& t = parsed.emplace_back();
+			if (parse_term(part, t)) qualified = true;
 			else {
-				switch (v_index(sort_vector, sorting)) {
-				case 3: rng::stable_sort(proc_vec, [](const auto& a, const auto& b) { return a.entry.get().threads > b.entry.get().threads; });	break;
-				case 5: rng::stable_sort(proc_vec, [](const auto& a, const auto& b) { return a.entry.get().mem > b.entry.get().mem; });	break;
-				case 6: rng::stable_sort(proc_vec, [](const auto& a, const auto& b) { return a.entry.get().cpu_p > b.entry.get().cpu_p; });	break;
-				case 7: rng::stable_sort(proc_vec, [](const auto& a, const auto& b) { return a.entry.get().cpu_c > b.entry.get().cpu_c; });	break;
-				}
+				t = {};
+				t.negate = (part.starts_with('!') and part.size() > 1);
+				t.text = part.substr(t.negate ? 1 : 0);
 			}
 		}
 
-		for (auto& r : proc_vec) {
-			r.entry.get().tree_index = (collapsed or r.entry.get().filtered ? index_max : c_index++);
-			if (not r.children.empty()) {
-				tree_sort(r.children, sorting, reverse, c_index, (collapsed or r.entry.get().collapsed or r.entry.get().tree_index == (size_t)index_max));
+		if (qualified) {
+			//? Incomplete terms, like an invalid regex or a missing number while still typing, are left out
+			for (auto& t : parsed) {
+				if (t.compare == op::regex and not t.regex) continue;
+				if (t.target != field::any and t.compare != op::contains and t.compare != op::regex and not t.text.empty()) continue;
+				if (t.compare == op::contains and t.text.empty() and t.target != field::any) continue;
+				terms.push_back(std::move(t));
 			}
 		}
+		//? Match whole filter against pid, name, command and user, as a regex if starting with !
+		else if (filter.starts_with('!')) {
+			term t;
+			if (filter.size() > 1 and make_regex(t, std::string_view{filter}.substr(1)))
+				terms.push_back(std::move(t));
+		}
+		else if (not filter.empty()) {
+			term t;
+			t.text = filter;
+			terms.push_back(std::move(t));
+		}
 	}
 
-	bool matches_filter(const proc_info& proc, const std::string& filter) {
-		if (filter.starts_with("!")) {
-			if (filter.size() == 1) {
-				return true;
+	bool filter_query::matches(const proc_info& proc) const {
+		if (terms.empty()) return true;
+
+		array<char, 24> pid_buf;
+		const auto pid_end = std::to_chars(pid_buf.data(), pid_buf.data() + pid_buf.size(), proc.pid).ptr;
+		const std::string_view pid_str{pid_buf.data(), (size_t)(pid_end - pid_buf.data())};
+
+		auto match_text = [&](const term& t, std::string_view value, bool case_sensitive) {
+			if (t.compare == op::regex) return std::regex_search(value.begin(), value.end(), *t.regex);
+			return (case_sensitive ? value.find(t.text) != std::string_view::npos : contains_ic(value, t.text));
+		};
+
+		auto compare = [](op compare, double value, double number) {
+			switch (compare) {
+				case op::equal: return value == number;
+				case op::less: return value < number;
+				case op::less_equal: return value <= number;
+				case op::greater: return value > number;
+				case op::greater_equal: return value >= number;
+				default: return false;
 			}
-			std::regex regex{filter.substr(1), std::regex::extended};
-			return std::regex_search(std::to_string(proc.pid), regex) ||
-				   std::regex_search(proc.name, regex) || std::regex_match(proc.cmd, regex) ||
-				   std::regex_search(proc.user, regex);
-		} else {
-			return s_contains(std::to_string(proc.pid), filter) ||
-				   s_contains_ic(proc.name, filter) || s_contains_ic(proc.cmd, filter) ||
-				   s_contains_ic(proc.user, filter);
+		};
+
+		for (const auto& t : terms) {
+			bool match = false;
+			switch (t.target) {
+				case field::any:
+					match = match_text(t, pid_str, true) or match_text(t, proc.name, false)
+						or match_text(t, proc.cmd.str(), false) or match_text(t, proc.user.str(), false);
+					break;
+				case field::pid:
+					match = (t.compare == op::contains or t.compare == op::regex ? match_text(t, pid_str, true) : compare(t.compare, proc.pid, t.number));
+					break;
+				case field::name: match = match_text(t, proc.name, false); break;
+				case field::cmd: match = match_text(t, proc.cmd.str(), false); break;
+				case field::user: match = match_text(t, proc.user.str(), false); break;
+				case field::cpu: match = compare(t.compare, proc.cpu_p, t.number); break;
+				case field::mem: match = compare(t.compare, proc.mem, t.number); break;
+				case field::threads: match = compare(t.compare, proc.threads, t.number); break;
+			}
+			if (match == t.negate) return false;
 		}
+		return true;
 	}
 
-	void _tree_gen(proc_info& cur_proc, vector<proc_info>& in_procs, vector<tree_proc>& out_procs,
-		int cur_depth, bool collapsed, const string& filter, bool found, bool no_update, bool should_filter) {
-		auto cur_pos = out_procs.size();
-		bool filtering = false;
+	bool filter_query::cacheable() const {
+		return rng::all_of(terms, [](const term& t) { return t.compare == op::contains or t.compare == op::regex or t.target == field::pid; });
+	}
 
-		//? If filtering, include children of matching processes
-		if (not found and (should_filter or not filter.empty())) {
-			if (!matches_filter(cur_proc, filter)) {
-				filtering = true;
-				cur_proc.filtered = true;
-				filter_found++;
-			}
-			else {
-				found = true;
-				cur_depth = 0;
-			}
+	bool filter_query::uses_names() const {
+		return rng::any_of(terms, [](const term& t) {
+			return t.target == field::any or t.target == field::name or t.target == field::cmd or t.target == field::user;
+		});
+	}
+
+	bool filter_query::narrows(const filter_query& previous) const {
+		if (previous.terms.empty() or previous.terms.size() > terms.size() or not filter.starts_with(previous.filter)) return false;
+
+		//? Text searches only, all terms but the last must be the same and the last can only have grown
+		for (size_t i = 0; i < previous.terms.size(); i++) {
+			const auto& old_term = previous.terms[i];
+			const auto& new_term = terms[i];
+			if (old_term.compare != op::contains or new_term.compare != op::contains or old_term.negate or new_term.negate
+			or old_term.target != new_term.target or not new_term.text.starts_with(old_term.text)
+			or (i + 1 < previous.terms.size() and new_term.text != old_term.text))
+				return false;
 		}
-		else if (cur_proc.filtered) cur_proc.filtered = false;
+		return true;
+	}
 
-		cur_proc.depth = cur_depth;
+	bool matches_filter(proc_info& proc, const std::string& filter) {
+		static filter_query query;
+		static uint32_t generation{1};
+		static bool narrowing{};
+		if (query.source() != filter) {
+			filter_query next{filter};
+			narrowing = next.narrows(query);
+			query = std::move(next);
+			if (++generation == 0) generation = 1;
+		}
+		if (not query.cacheable()) return query.matches(proc);
 
-		//? Set tree index position for process if not filtered out or currently in a collapsed sub-tree
-		out_procs.push_back({ cur_proc, {} });
-		if (not collapsed and not filtering) {
-			cur_proc.tree_index = out_procs.size() - 1;
+		if (proc.filter_gen == generation) return proc.filter_match;
+		if (not (narrowing and proc.filter_gen != 0 and proc.filter_gen == generation - 1 and not proc.filter_match))
+			proc.filter_match = query.matches(proc);
+		proc.filter_gen = generation;
+		return proc.filter_match;
+	}
 
-			//? Try to find name of the binary file and append to program name if not the same
-			if (cur_proc.short_cmd.empty() and not cur_proc.cmd.empty()) {
-				std::string_view cmd_view = cur_proc.cmd;
-				cmd_view = cmd_view.substr((size_t)0, std::min(cmd_view.find(' '), cmd_view.size()));
-				cmd_view = cmd_view.substr(std::min(cmd_view.find_last_of('/') + 1, cmd_view.size()));
-				cur_proc.short_cmd = string{cmd_view};
-			}
+	bool filter_uses_names(const std::string& filter) {
+		static filter_query query;
+		if (query.source() != filter) query = filter_query{filter};
+		return query.uses_names();
+	}
+
+	void set_short_cmd(proc_info& proc) {
+		std::string_view cmd_view = proc.cmd.str();
+		cmd_view = cmd_view.substr((size_t)0, std::min(cmd_view.find(' '), cmd_view.size()));
+		cmd_view = cmd_view.substr(std::min(cmd_view.find_last_of('/') + 1, cmd_view.size()));
+		proc.short_cmd = cmd_view;
+	}
+
+	void tree_gen(vector<proc_info>& procs, const string& sorting, bool reverse, const string& filter, bool no_update, bool should_filter) {
+		constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+		const uint32_t size = procs.size();
+		const bool aggregate = Config::getB("proc_aggregate");
+		const bool filtering_active = (should_filter or not filter.empty());
+
+		//* Tree is kept as first child and next sibling indices into procs, buffers are reused between updates
+		static std::unordered_map<size_t, uint32_t> index;
+		static vector<uint32_t> parent, first_child, next_sibling, order;
+		static vector<bool> visited;
+		uint32_t root_head = none, root_tail = none;
+
+		auto link_root = [&](uint32_t i) {
+			if (root_tail == none) root_head = i;
+			else next_sibling[root_tail] = i;
+			root_tail = i;
+		};
+
+		index.clear();
+		index.reserve(size);
+		for (uint32_t i = 0; i < size; i++) index.emplace(procs[i].pid, i);
+
+		//? Children are linked in reverse so that every list ends up in the current order of procs
+		parent.assign(size, none);
+		first_child.assign(size, none);
+		next_sibling.assign(size, none);
+		for (uint32_t i = size; i-- > 0;) {
+			const auto found = (procs[i].ppid != procs[i].pid ? index.find(procs[i].ppid) : index.end());
+			if (found == index.end()) continue;
+			parent[i] = found->second;
+			next_sibling[i] = first_child[found->second];
+			first_child[found->second] = i;
 		}
-		else {
-			cur_proc.tree_index = in_procs.size();
+		for (uint32_t i = 0; i < size; i++) {
+			if (parent[i] == none) link_root(i);
 		}
 
-		//? Recursive iteration over all children
-		for (auto& p : rng::equal_range(in_procs, cur_proc.pid, rng::less{}, &proc_info::ppid)) {
-			if (collapsed and not filtering) {
-				cur_proc.filtered = true;
+		//* Depth first walk with an explicit stack, filtering and depth are passed down and resources aggregated on the way up
+		struct frame {
+			uint32_t proc;
+			uint32_t next_child;
+			size_t depth;
+			bool collapsed;		// inside a collapsed sub-tree
+			bool found;			// this process or a parent matched the filter
+			bool filtering;		// this process is filtered out
+		};
+		static vector<frame> stack;
+
+		auto enter = [&](uint32_t i, size_t depth, bool collapsed, bool found) {
+			auto& cur_proc = procs[i];
+			bool filtering = false;
+			visited[i] = true;
+
+			//? If filtering, include children of matching processes
+			if (not found and filtering_active) {
+				if (not matches_filter(cur_proc, filter)) {
+					filtering = true;
+					cur_proc.filtered = true;
+				}
+				else {
+					found = true;
+					depth = 0;
+				}
 			}
+			else if (cur_proc.filtered) cur_proc.filtered = false;
+
+			cur_proc.depth = depth;
+			cur_proc.tree_index = (collapsed or filtering ? size : 0);
+
+			//? Try to find name of the binary file and append to program name if not the same,
+			//? collectors that defer reading cmd set it when the names are loaded since that happens after this
+			if (not collapsed and not filtering and cur_proc.short_cmd.empty() and not cur_proc.cmd.empty())
+				set_short_cmd(cur_proc);
+
+			stack.push_back({i, first_child[i], depth, collapsed, found, filtering});
+		};
 
-			_tree_gen(p, in_procs, out_procs.back().children, cur_depth + 1, (collapsed or cur_proc.collapsed), filter, found, no_update, should_filter);
+		auto leave = [&](const frame& f) {
+			auto& cur_proc = procs[f.proc];
 
-			if (not no_update and not filtering and (collapsed or cur_proc.collapsed)) {
-				//auto& parent = cur_proc;
-				cur_proc.cpu_p += p.cpu_p;
-				cur_proc.cpu_c += p.cpu_c;
-				cur_proc.mem += p.mem;
-				cur_proc.threads += p.threads;
-				filter_found++;
-				p.filtered = true;
+			//? Add collapse/expand symbols if process have any children
+			if (not f.collapsed and not f.filtering)
+				cur_proc.prefix = " │ "s * f.depth + (first_child[f.proc] != none ? (cur_proc.collapsed ? "[+]─" : "[-]─") : " ├─ ");
+
+			if (stack.empty()) return;
+			const auto& up = stack.back();
+			auto& parent_proc = procs[up.proc];
+			if (not no_update and not up.filtering and (up.collapsed or parent_proc.collapsed)) {
+				parent_proc.cpu_p += cur_proc.cpu_p;
+				parent_proc.cpu_c += cur_proc.cpu_c;
+				parent_proc.mem += cur_proc.mem;
+				parent_proc.threads += cur_proc.threads;
+				cur_proc.filtered = true;
+			}
+			else if (aggregate) {
+				parent_proc.cpu_p += cur_proc.cpu_p;
+				parent_proc.cpu_c += cur_proc.cpu_c;
+				parent_proc.mem += cur_proc.mem;
+				parent_proc.threads += cur_proc.threads;
 			}
-			else if (Config::getB("proc_aggregate")) {
-				cur_proc.cpu_p += p.cpu_p;
-				cur_proc.cpu_c += p.cpu_c;
-				cur_proc.mem += p.mem;
-				cur_proc.threads += p.threads;
+		};
+
+		auto walk = [&](uint32_t root) {
+			enter(root, 0, false, false);
+			while (not stack.empty()) {
+				auto& top = stack.back();
+				while (top.next_child != none and visited[top.next_child]) top.next_child = next_sibling[top.next_child];
+				if (top.next_child != none) {
+					const uint32_t child = top.next_child;
+					top.next_child = next_sibling[child];
+					//? Collapsing only hides the children of processes that are shown
+					enter(child, top.depth + 1, (top.collapsed or (procs[top.proc].collapsed and not top.filtering)), top.found);
+					continue;
+				}
+				const frame done = top;
+				stack.pop_back();
+				leave(done);
 			}
+		};
+
+		visited.assign(size, false);
+		for (uint32_t i = root_head; i != none; i = next_sibling[i]) walk(i);
+
+		//? Processes left are in a loop of parent pids (pid reuse between reads), cut the loop and make them roots
+		for (uint32_t i = 0; i < size; i++) {
+			if (visited[i]) continue;
+			uint32_t* link = &first_child[parent[i]];
+			while (*link != i) link = &next_sibling[*link];
+			*link = next_sibling[i];
+			next_sibling[i] = none;
+			parent[i] = none;
+			link_root(i);
+			walk(i);
 		}
-		if (collapsed or filtering) {
-			return;
+
+		//* Sort siblings by values that can have been changed by aggregation
+		auto sort_siblings = [&](auto proj) {
+			auto sort_list = [&](uint32_t& head) {
+				if (head == none or next_sibling[head] == none) return;
+				order.clear();
+				for (uint32_t i = head; i != none; i = next_sibling[i]) order.push_back(i);
+				if (reverse) rng::stable_sort(order, rng::less{}, [&](uint32_t i) { return std::invoke(proj, procs[i]); });
+				else rng::stable_sort(order, rng::greater{}, [&](uint32_t i) { return std::invoke(proj, procs[i]); });
+				head = order.front();
+				for (size_t n = 0; n < order.size(); n++) next_sibling[order[n]] = (n + 1 < order.size() ? order[n + 1] : none);
+				if (&head == &root_head) root_tail = order.back();
+			};
+			sort_list(root_head);
+			for (uint32_t i = 0; i < size; i++) sort_list(first_child[i]);
+		};
+		switch (v_index(sort_vector, sorting)) {
+			case 3: sort_siblings(&proc_info::threads);	break;
+			case 5: sort_siblings(&proc_info::mem);		break;
+			case 6: sort_siblings(&proc_info::cpu_p);	break;
+			case 7: sort_siblings(&proc_info::cpu_c);	break;
 		}
 
-		//? Add tree terminator symbol if it's the last child in a sub-tree
-		if (out_procs.back().children.size() > 0 and out_procs.back().children.back().entry.get().prefix.size() >= 8 and not out_procs.back().children.back().entry.get().prefix.ends_with("]─"))
-			out_procs.back().children.back().entry.get().prefix.replace(out_procs.back().children.back().entry.get().prefix.size() - 8, 8, " └─ ");
+		//* Final pre-order walk giving shown processes their position in the list
+		static vector<uint32_t> cursors;
+		order.clear();
+		cursors.assign(1, root_head);
+		while (not cursors.empty()) {
+			auto& cursor = cursors.back();
+			if (cursor == none) {
+				cursors.pop_back();
+				continue;
+			}
+			const uint32_t i = cursor;
+			cursor = next_sibling[i];
+			auto& cur_proc = procs[i];
+			if (not cur_proc.filtered and cur_proc.tree_index != size) {
+				cur_proc.tree_index = order.size();
+				order.push_back(i);
+
+				//? Add tree terminator symbol if it's the last child in a sub-tree
+				if (first_child[i] != none and not cur_proc.collapsed) {
+					uint32_t last = first_child[i];
+					while (next_sibling[last] != none) last = next_sibling[last];
+					auto& last_prefix = procs[last].prefix;
+					if (last_prefix.size() >= 8 and not last_prefix.ends_with("]─"))
+						last_prefix.replace(last_prefix.size() - 8, 8, " └─ ");
+				}
+			}
+			else {
+				cur_proc.tree_index = size;
+			}
+			if (first_child[i] != none) cursors.push_back(first_child[i]);
+		}
 
-		//? Add collapse/expand symbols if process have any children
-		out_procs.at(cur_pos).entry.get().prefix = " │ "s * cur_depth + (out_procs.at(cur_pos).children.size() > 0 ? (cur_proc.collapsed ? "[+]─" : "[-]─") : " ├─ ");
+		//? Add tree begin symbol to first item and terminator symbol to last item if childless
+		if (root_head != none and first_child[root_head] == none and procs[root_head].prefix.size() >= 8)
+			procs[root_head].prefix.replace(procs[root_head].prefix.size() - 8, 8, " ┌─ ");
+		if (root_tail != none and first_child[root_tail] == none and procs[root_tail].prefix.size() >= 8)
+			procs[root_tail].prefix.replace(procs[root_tail].prefix.size() - 8, 8, " └─ ");
 
+		//? Move processes into tree order with hidden processes last
+		static vector<proc_info> sorted;
+		sorted.clear();
+		sorted.reserve(size);
+		for (const auto i : order) sorted.push_back(std::move(procs[i]));
+		for (uint32_t i = 0; i < size; i++) {
+			if (procs[i].tree_index == size) sorted.push_back(std::move(procs[i]));
+		}
+		procs.swap(sorted);
+		filter_found = size - order.size();
 	}
 
 }
@@ -22,10 +22,13 @@ tab-size = 4
 #include <atomic>
 #include <deque>
 #include <filesystem>
+#include <optional>
+#include <regex>
 #include <string>
 #include <tuple>
 #include <vector>
 #include <unordered_map>
+#include <utility>
 #include <unistd.h>
 
 // From `man 3 getifaddrs`: <net/if.h> must be included before <ifaddrs.h>
@@ -351,8 +354,34 @@ namespace Proc {
 		"memory",
 		"cpu direct",
 		"cpu lazy",
+		"io read",
+		"io write",
+		"io total",
+		"cpu wait",
+		"cpu 1s",
+		"cpu 10s",
+		"cpu 60s",
 	};
 
+	//? Contains the optional columns that can be shown with config "proc_columns"
+	const vector<string> column_vector = {
+		"io_read",
+		"io_write",
+		"io_total",
+		"swap",
+		"ctx_vol",
+		"ctx_invol",
+		"fds",
+		"age",
+		"wait",
+		"cpu_1s",
+		"cpu_10s",
+		"cpu_60s",
+	};
+
+	//? Time constants in seconds of the decaying cpu averages in proc_info::cpu_avg
+	const array<double, 3> cpu_avg_windows = { 1.0, 10.0, 60.0 };
+
 	//? Translation from process state char to explanative string
 	const std::unordered_map<char, string> proc_states = {
 		{'R', "Running"},
@@ -368,15 +397,63 @@ namespace Proc {
 		{'P', "Parked"}
 	};
 
+	//* Reference counted handle to a string interned by content, so processes running the same command share one copy
+	//* The table is locked since processes can be collected on several threads, moving a handle doesn't touch it
+	class shared_string {
+	public:
+		struct entry;
+	private:
+		entry* ref{};
+		void release();
+	public:
+		shared_string() = default;
+		shared_string(std::string_view text);
+		shared_string(const string& text) : shared_string(std::string_view{text}) {}
+		shared_string(const char* text) : shared_string(std::string_view{text}) {}
+		shared_string(const shared_string& other);
+		shared_string(shared_string&& other) noexcept : ref(std::exchange(other.ref, nullptr)) {}
+		shared_string& operator=(const shared_string& other);
+		shared_string& operator=(shared_string&& other) noexcept;
+		~shared_string() { release(); }
+
+		const string& str() const;
+		operator const string&() const { return str(); }
+		bool empty() const { return ref == nullptr; }
+		size_t size() const { return str().size(); }
+		void clear() { release(); }
+
+		//* True if the string contains wide characters, checked once for each interned string
+		bool wide() const;
+	};
+
+	//* Handle to a user name interned in a table shared by all processes, so processes of the same user share one string
+	//* The table is only used from the runner thread
+	class user_handle {
+		uint32_t id{};
+	public:
+		user_handle() = default;
+		user_handle(std::string_view name);
+		user_handle(const string& name) : user_handle(std::string_view{name}) {}
+		user_handle(const char* name) : user_handle(std::string_view{name}) {}
+
+		const string& str() const;
+		operator const string&() const { return str(); }
+		bool empty() const { return id == 0; }
+
+		//* Position of the name in alphabetical order of all interned names, used for sorting
+		uint32_t rank() const;
+
+		bool operator==(const user_handle& other) const = default;
+	};
+
 	//* Container for process information
 	struct proc_info {
 		size_t pid{};
 		string name{};          // defaults to ""
-		string cmd{};           // defaults to ""
-		string short_cmd{};     // defaults to ""
+		shared_string cmd{};    // defaults to ""
+		shared_string short_cmd{}; // defaults to ""
 		size_t threads{};
-		int name_offset{};
-		string user{};          // defaults to ""
+		user_handle user{};     // defaults to ""
 		uint64_t mem{};
 		double cpu_p{};         // defaults to = 0.0
 		double cpu_c{};         // defaults to = 0.0
@@ -385,19 +462,42 @@ namespace Proc {
 		uint64_t ppid{};
 		uint64_t cpu_s{};
 		uint64_t cpu_t{};
+		uint64_t cpu_children{};
+		uint64_t io_read{};		// bytes read from storage per second since last update
+		uint64_t io_write{};	// bytes written to storage per second since last update
+		uint64_t io_read_bytes{};
+		uint64_t io_write_bytes{};
+		double io_time{};		// system uptime when io_read_bytes and io_write_bytes were read, 0 if never
+		shared_string cgroup{};	// cgroup v2 path, only read while cgroup view is used
+		uint64_t swap{};		// swap, context switches and open files are read in turns for a few processes per update
+		uint64_t ctx_vol{};
+		uint64_t ctx_invol{};
+		int64_t fds = -1;		// -1 if not read or not readable
+		double slow_time{};		// system uptime when swap, context switches and open files were read, 0 if never
+		uint64_t exec_ns{};		// run time and run queue wait in nanoseconds, only read with config "proc_schedstat"
+		uint64_t wait_ns{};
+		uint64_t sched_time{};	// monotonic clock in nanoseconds when schedstat was read, 0 if not read
+		double cpu_wait{};		// percent of time spent waiting to run since last update for the main thread, 0-100
+		array<double, 3> cpu_avg{};	// cpu usage decayed over each of cpu_avg_windows, like load averages
+		double avg_time{};		// time in seconds of the last sample added to cpu_avg, negated after the first call, 0 if none
 		string prefix{};        // defaults to ""
 		size_t depth{};
 		size_t tree_index{};
 		bool collapsed{};
 		bool filtered{};
+		bool filter_match{};	// cached filter result, valid while filter_gen matches the current filter
+		uint32_t filter_gen{};	// reset to 0 when name, cmd or user changes
+		bool names_pending{};	// name, cmd and user not read yet, only loaded when needed
 	};
 
 	//* Container for process info box
 	struct detail_container {
 		size_t last_pid{};
 		bool skip_smaps{};
+		bool skip_rollup{};
 		proc_info entry;
 		string elapsed, parent, status, io_read, io_write, memory;
+		string mem_details;		// rss, uss and swap when memory is proportional set size
 		long long first_mem = -1;
 		deque<long long> cpu_percent;
 		deque<long long> mem_bytes;
@@ -406,6 +506,14 @@ namespace Proc {
 	//? Contains all info for proc detailed box
 	extern detail_container detailed;
 
+	//* Processes started and exited between two updates, only collected when "proc_events" is enabled
+	struct transient_info {
+		size_t count{};
+		double cpu_p{};
+	};
+
+	extern transient_info transient;
+
 	//* Collect and sort process information from /proc
 	auto collect(bool no_update = false) -> vector<proc_info>&;
 
@@ -415,22 +523,68 @@ namespace Proc {
 	//* Draw contents of proc box using <plist> as data source
 	string draw(const vector<proc_info>& plist, bool force_redraw = false, bool data_same = false);
 
-	struct tree_proc {
-		std::reference_wrapper<proc_info> entry;
-		vector<tree_proc> children;
+	//* Add the current cpu usage of <p> to its decaying averages in constant time, <now> is a time in seconds
+	//* The first call only sets the time since the first cpu usage isn't known, the second sets all averages to the current usage
+	void update_cpu_avg(proc_info& p, double now);
+
+	//* Sort vector of proc_info's, if <limit> is set and not in tree mode only the first <limit> unfiltered entries are guaranteed
+	//* to be in order, returns number of entries in order
+	size_t proc_sorter(vector<proc_info>& proc_vec, const string& sorting, bool reverse, bool tree = false, size_t limit = 0);
+
+	//* Process filter compiled from a filter string, all space separated terms have to match:
+	//*  text               pid, name, command or user contains text (case insensitive)
+	//*  field:text         only look in field, one of pid, name, cmd or user (pid compares exact)
+	//*  field:/regex/      extended regex search in field
+	//*  cpu>5 mem>=1G      numeric comparison with <, <=, >, >= or = against cpu, mem, threads or pid, mem takes K, M, G and T suffixes
+	//*  !term              negate term
+	//* Filters without any field or numeric terms are matched as a whole, with a leading ! for a regex
+	class filter_query {
+	public:
+		enum class field : uint8_t { any, pid, name, cmd, user, cpu, mem, threads };
+		enum class op : uint8_t { contains, regex, equal, less, less_equal, greater, greater_equal };
+
+		struct term {
+			field target = field::any;
+			op compare = op::contains;
+			bool negate{};
+			string text{};
+			std::optional<std::regex> regex{};
+			double number{};
+		};
+
+		filter_query() = default;
+		explicit filter_query(const string& filter);
+
+		//* Check if <proc> matches all terms, doesn't allocate unless a regex is used
+		bool matches(const proc_info& proc) const;
+
+		//* True if the result only depends on pid, name, cmd and user and can be cached until any of them change
+		bool cacheable() const;
+
+		//* True if any term matches against name, command or user
+		bool uses_names() const;
+
+		//* True if everything matching this filter is known to also match <previous>, like when more text has been typed
+		bool narrows(const filter_query& previous) const;
+
+		const string& source() const { return filter; }
+
+	private:
+		string filter{};
+		vector<term> terms{};
 	};
 
-	//* Sort vector of proc_info's
-	void proc_sorter(vector<proc_info>& proc_vec, const string& sorting, bool reverse, bool tree = false);
+	//* Match <proc> against <filter>, compiling the filter only when it has changed since last call
+	//* Results are cached in <proc> when possible, and when the filter narrows the last one only previous matches are tested again
+	bool matches_filter(proc_info& proc, const std::string& filter);
 
-	//* Recursive sort of process tree
-	void tree_sort(vector<tree_proc>& proc_vec, const string& sorting,
-				   bool reverse, int& c_index, const int index_max, bool collapsed = false);
+	//* True if <filter> compares any text field, so that name, command and user need to be known for all processes
+	bool filter_uses_names(const std::string& filter);
 
-	bool matches_filter(const proc_info& proc, const std::string& filter);
+	//* Set short_cmd of <proc> to the file name of the executable in cmd, shown in tree view when the command doesn't fit
+	void set_short_cmd(proc_info& proc);
 
-	//* Generate process tree list
-	void _tree_gen(proc_info& cur_proc, vector<proc_info>& in_procs, vector<tree_proc>& out_procs,
-				   int cur_depth, bool collapsed, const string& filter,
-				   bool found = false, bool no_update = false, bool should_filter = false);
+	//* Generate process tree list, reorders <procs> with shown processes in tree order first and sets prefix, depth and tree_index
+	//* Processes with a parent not in <procs> become roots, children keep the order they had in <procs> unless sorted by tree values
+	void tree_gen(vector<proc_info>& procs, const string& sorting, bool reverse, const string& filter, bool no_update, bool should_filter);
 }
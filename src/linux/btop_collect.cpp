@@ -16,7 +16,10 @@ indent = tab
 tab-size = 4
 */
 
+#include <charconv>
 #include <cstdlib>
+#include <fcntl.h>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <fstream>
@@ -24,13 +27,28 @@ tab-size = 4
 #include <cmath>
 #include <unistd.h>
 #include <numeric>
+#include <optional>
+#include <regex>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/statvfs.h>
+#include <sys/syscall.h>
 #include <netdb.h>
 #include <ifaddrs.h>
 #include <net/if.h>
 #include <arpa/inet.h> // for inet_ntop()
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/io_uring.h>
+#include <linux/netlink.h>
+#include <condition_variable>
 #include <filesystem>
+#include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <dlfcn.h>
 #include <unordered_map>
 #include <utility>
@@ -236,13 +254,33 @@ namespace Gpu {
 
 namespace Mem {
 	double old_uptime;
+	uint64_t scope_mem_max{};
 }
 
 namespace Shared {
 
-	fs::path procPath, passwd_path;
+	fs::path procPath, passwd_path, cgroupPath;
 	long pageSize, clkTck, coreCount;
 
+	//* Directory of the cgroup set with config "cgroup_scope" or the --cgroup option, empty if not set or not a cgroup v2 directory
+	const fs::path& scope_dir() {
+		static string spec;
+		static fs::path dir;
+		const auto& current = (Config::getS("cgroup_arg").empty() ? Config::getS("cgroup_scope") : Config::getS("cgroup_arg"));
+		if (current == spec) return dir;
+		spec = current;
+		dir.clear();
+		if (spec.empty()) return dir;
+
+		//? Both paths below the cgroup v2 mount and paths as shown in /proc/[pid]/cgroup are accepted
+		const fs::path path = (spec.starts_with(cgroupPath.string() + "/") ? fs::path(spec) : cgroupPath / fs::path(spec).relative_path());
+		if (access((path / "cgroup.procs").c_str(), R_OK) == 0)
+			dir = path.lexically_normal();
+		else
+			Logger::warning("Not a readable cgroup v2 directory: " + path.string() + ", collecting all processes.");
+		return dir;
+	}
+
 	void init() {
 
 		//? Shared global variables init
@@ -250,6 +288,16 @@ namespace Shared {
 		if (procPath.empty())
 			throw std::runtime_error("Proc filesystem not found or no permission to read from it!");
 
+		//? Mount point of the unified hierarchy, /sys/fs/cgroup/unified on systems with both v1 and v2 hierarchies
+		cgroupPath = "/sys/fs/cgroup";
+		ifstream mounts(procPath / "self/mounts");
+		for (string device, mount_point, type; mounts >> device >> mount_point >> type; mounts.ignore(SSmax, '\n')) {
+			if (type == "cgroup2") {
+				cgroupPath = mount_point;
+				break;
+			}
+		}
+
 		passwd_path = (fs::is_regular_file(fs::path("/etc/passwd")) and access("/etc/passwd", R_OK) != -1) ? "/etc/passwd" : "";
 		if (passwd_path.empty())
 			Logger::warning("Could not read /etc/passwd, will show UID instead of username.");
@@ -844,6 +892,43 @@ namespace Cpu {
 		return {percent, watts, seconds, status};
 	}
 
+	//* Replace the total, user and system values from /proc/stat with the usage in cpu.stat of cgroup <dir> over the same <total_ticks>,
+	//* as percent of the cpu.max quota if one is set and otherwise of all cores, an empty <dir> resets the starting values
+	void collect_scope(cpu_info& cpu, const fs::path& dir, long long total_ticks) {
+		static fs::path last_dir;
+		static uint64_t old_usage{}, old_user{}, old_system{};
+		if (dir.empty()) {
+			last_dir.clear();
+			return;
+		}
+		uint64_t usage{}, user{}, system{};
+		ifstream cread(dir / "cpu.stat");
+		for (string key; cread >> key;) {
+			if (key == "usage_usec") cread >> usage;
+			else if (key == "user_usec") cread >> user;
+			else if (key == "system_usec") cread >> system;
+			cread.ignore(SSmax, '\n');
+		}
+		cread.close();
+
+		//? Time all cores could have run in microseconds, reduced to the share of cores allowed by the quota
+		double capacity = (double)total_ticks * 1'000'000 / Shared::clkTck;
+		cread.clear();
+		cread.open(dir / "cpu.max");
+		string quota;
+		uint64_t period{};
+		if (cread >> quota >> period and isint(quota) and period > 0)
+			capacity = min(capacity, capacity / Shared::coreCount * stoull(quota) / period);
+
+		//? The first update after setting the scope only sets the starting values
+		const bool has_last = (dir == last_dir);
+		last_dir = dir;
+		for (auto [name, now, old] : {tuple{"total"s, usage, &old_usage}, tuple{"user"s, user, &old_user}, tuple{"system"s, system, &old_system}}) {
+			cpu.cpu_percent.at(name).back() = (has_last ? clamp((long long)round((double)(now - min(now, *old)) * 100 / max(1.0, capacity)), 0ll, 100ll) : 0);
+			*old = now;
+		}
+	}
+
 	auto collect(bool no_update) -> cpu_info& {
 		if (Runner::stopping or (no_update and not current_cpu.cpu_percent.at("total").empty())) return current_cpu;
 		auto& cpu = current_cpu;
@@ -856,6 +941,7 @@ namespace Cpu {
 		}
 
 		ifstream cread;
+		long long total_ticks{};
 
 		try {
 			//? Get cpu total times for all cores from /proc/stat
@@ -920,6 +1006,7 @@ namespace Cpu {
 						const long long calc_idles = max(1ll, idles - cpu_old.at("idles"));
 						cpu_old.at("totals") = totals;
 						cpu_old.at("idles") = idles;
+						total_ticks = calc_totals;
 
 						//? Total usage of cpu
 						cpu.cpu_percent.at("total").push_back(clamp((long long)round((double)(calc_totals - calc_idles) * 100 / calc_totals), 0ll, 100ll));
@@ -968,6 +1055,9 @@ namespace Cpu {
 				while (cmp_less(current_cpu.temp.size(), cpu.core_percent.size() + 1)) current_cpu.temp.push_back({0});
 			}
 
+			//? Usage of the cgroup scope instead of the whole system if set, values for each core are still from /proc/stat
+			collect_scope(cpu, Shared::scope_dir(), total_ticks);
+
 		}
 		catch (const std::exception& e) {
 			Logger::debug("Cpu::collect() : " + string{e.what()});
@@ -1760,9 +1850,39 @@ namespace Mem {
 		if (not meminfo.good() or totalMem == 0)
 			throw std::runtime_error("Could not get total memory size from /proc/meminfo");
 
+		//? Limited to memory.max of the cgroup scope if set
+		if (scope_mem_max > 0 and not Shared::scope_dir().empty()) return min((uint64_t)totalMem, scope_mem_max);
 		return totalMem;
 	}
 
+	//* Replace used, available, cached and free memory with memory.current and memory.stat of cgroup <dir> and set scope_mem_max from memory.max,
+	//* page cache that can be reclaimed is counted as available like MemAvailable in /proc/meminfo
+	void collect_scope(mem_info& mem, const fs::path& dir) {
+		scope_mem_max = 0;
+		if (dir.empty()) return;
+		uint64_t current{}, file{}, inactive_file{};
+		ifstream mread(dir / "memory.current");
+		if (not (mread >> current)) return;
+		mread.close();
+		mread.clear();
+		mread.open(dir / "memory.stat");
+		for (string key; mread >> key;) {
+			if (key == "file") mread >> file;
+			else if (key == "inactive_file") mread >> inactive_file;
+			mread.ignore(SSmax, '\n');
+		}
+		mread.close();
+		mread.clear();
+		mread.open(dir / "memory.max");
+		if (string limit; mread >> limit and isint(limit)) scope_mem_max = stoull(limit);
+
+		const uint64_t total = get_totalMem();
+		mem.stats.at("used") = min(total, current - min(current, inactive_file));
+		mem.stats.at("available") = total - mem.stats.at("used");
+		mem.stats.at("cached") = min(total, file);
+		mem.stats.at("free") = total - min(total, current);
+	}
+
 	auto collect(bool no_update) -> mem_info& {
 		if (Runner::stopping or (no_update and not current_mem.percent.at("used").empty())) return current_mem;
 		auto show_swap = Config::getB("show_swap");
@@ -1838,6 +1958,10 @@ namespace Mem {
 
 		meminfo.close();
 
+		//? Memory of the cgroup scope instead of the whole system if set, swap is still from /proc/meminfo
+		collect_scope(mem, Shared::scope_dir());
+		totalMem = get_totalMem();
+
 		//? Calculate percentages
 		for (const auto& name : mem_names) {
 			mem.percent.at(name).push_back(round((double)mem.stats.at(name) * 100 / totalMem));
@@ -2525,12 +2649,13 @@ namespace Net {
 namespace Proc {
 
 	vector<proc_info> current_procs;
-	std::unordered_map<string, string> uid_user;
+	std::unordered_map<uint32_t, user_handle> uid_user;
 	string current_sort;
 	string current_filter;
 	bool current_rev{};
 
 	fs::file_time_type passwd_time;
+	ifstream passwd_file;
 
 	uint64_t cputimes;
 	int collapse = -1, expand = -1;
@@ -2542,6 +2667,1263 @@ namespace Proc {
 	constexpr size_t KTHREADD = 2;
 	static std::unordered_set<size_t> kernels_procs = {KTHREADD};
 
+	//* Fields used from /proc/[pid]/stat
+	struct pid_stat {
+		char state{};
+		uint64_t ppid{};
+		uint64_t cpu_t{};		// utime + stime
+		uint64_t cpu_children{};	// cutime + cstime
+		int64_t nice{};
+		uint64_t threads{};
+		uint64_t starttime{};
+		uint64_t rss{};
+	};
+
+	//* Index from pid to position in current_procs
+	std::unordered_map<size_t, size_t> pid_index;
+
+	//* Open /proc/[pid]/stat descriptors kept between updates and refreshed with pread(), limited by config "proc_fd_cache" and RLIMIT_NOFILE
+	std::unordered_map<size_t, int> stat_fds;
+
+	//* Open /proc/[pid]/io descriptors kept while io rates are shown or sorted on, io_denied marks processes that can't be read
+	std::unordered_map<size_t, int> io_fds;
+	constexpr int io_denied = -2;
+
+	//* Close and remove cached descriptor for <pid> if any
+	void close_stat_fd(size_t pid) {
+		if (auto cached = stat_fds.find(pid); cached != stat_fds.end()) {
+			close(cached->second);
+			stat_fds.erase(cached);
+		}
+	}
+
+	void close_io_fd(size_t pid) {
+		if (auto cached = io_fds.find(pid); cached != io_fds.end()) {
+			if (cached->second >= 0) close(cached->second);
+			io_fds.erase(cached);
+		}
+	}
+
+	//* Lists pids in /proc with getdents64, keeping the directory open and reusing a buffer that fits most systems in one call
+	class pid_reader {
+		//? Fixed part of the kernel's linux_dirent64, the null terminated name follows d_type
+		struct dirent_header {
+			uint64_t d_ino;
+			int64_t d_off;
+			unsigned short d_reclen;
+			unsigned char d_type;
+		};
+
+		int fd = -1;
+		vector<char> buf = vector<char>(128 << 10);
+
+		void reset() {
+			if (fd >= 0) close(fd);
+			fd = -1;
+		}
+
+		//* Append numeric entries of directory <dir_fd> to <out>, returns false on read errors
+		bool list(int dir_fd, vector<size_t>& out) {
+			while (true) {
+				const long len = syscall(SYS_getdents64, dir_fd, buf.data(), buf.size());
+				if (len < 0 and errno == EINTR) continue;
+				if (len < 0) return false;
+				if (len == 0) break;
+
+				for (long pos = 0; pos < len;) {
+					const char* record = buf.data() + pos;
+					pos += ((const dirent_header*)record)->d_reclen;
+					const char* c = record + offsetof(dirent_header, d_type) + 1;
+					if (not isdigit(*c)) continue;
+					size_t pid = 0;
+					for (; isdigit(*c); c++) pid = pid * 10 + (*c - '0');
+					if (*c == '\0') out.push_back(pid);
+				}
+			}
+
+			//? Procfs already lists pids and tids in ascending order
+			if (not rng::is_sorted(out)) rng::sort(out);
+			return true;
+		}
+
+	public:
+		~pid_reader() { reset(); }
+
+		//* Replace <out> with the sorted pids currently in /proc, returns false if /proc couldn't be read
+		bool read(vector<size_t>& out) {
+			out.clear();
+			if (fd >= 0 and lseek(fd, 0, SEEK_SET) < 0) reset();
+			if (fd < 0) fd = open(Shared::procPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (fd < 0) return false;
+			if (not list(fd, out)) {
+				reset();
+				return false;
+			}
+			return true;
+		}
+
+		//* Replace <out> with the sorted numeric entries of directory <path>, used for /proc/[pid]/task
+		bool read(const char* path, vector<size_t>& out) {
+			out.clear();
+			const int dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (dir_fd < 0) return false;
+			const bool good = list(dir_fd, out);
+			close(dir_fd);
+			return good;
+		}
+	};
+
+	pid_reader proc_dir;
+
+	//* Compare sorted pid lists from two updates in one pass, pids in both lists are still alive
+	void diff_pids(const vector<size_t>& last, const vector<size_t>& current, vector<size_t>& born, vector<size_t>& died) {
+		born.clear();
+		died.clear();
+		auto l = last.begin(), c = current.begin();
+		while (l != last.end() and c != current.end()) {
+			if (*l < *c) died.push_back(*l++);
+			else if (*c < *l) born.push_back(*c++);
+			else { ++l; ++c; }
+		}
+		died.insert(died.end(), l, last.end());
+		born.insert(born.end(), c, current.end());
+	}
+
+	//* Per process state for one update, filled in serially and then processed by the collecting threads
+	struct pid_work {
+		size_t pid{};
+		size_t index{};			// position in current_procs
+		int stat_fd = -1;		// cached stat descriptor, replaced by a newly opened one if fd_changed is set
+		bool no_cache{};
+		bool fd_changed{};
+		bool valid{};
+		bool kernel{};
+		bool exec{};			// program changed since last update, reread name and command
+		bool names_known{};		// name, command and user copied from parent, skip reading them
+		uint64_t children_delta{};	// increase in cpu time of reaped children since last update
+		uint64_t last_cpu_t{};		// cpu times before this update, restored if the update is dropped
+		uint64_t last_children{};
+		int io_fd = -1;			// cached io descriptor or io_denied, replaced if io_fd_changed is set
+		bool io_fd_changed{};
+		const char* ring_stat{};	// contents of stat if read by the io_uring batch
+		ssize_t ring_len = -1;
+	};
+
+	//* Minimal io_uring set up with raw syscalls, used to read the cached /proc/[pid]/stat descriptors in batches
+	//* into a registered buffer pool instead of one pread() call for each process
+	class stat_ring {
+		int ring_fd = -1;
+		bool failed{};
+		unsigned entries{};
+		void* sq_ptr = MAP_FAILED;
+		void* cq_ptr = MAP_FAILED;
+		void* sqe_ptr = MAP_FAILED;
+		size_t sq_len{}, cq_len{}, sqe_len{};
+		unsigned *sq_head{}, *sq_tail{}, *sq_mask{}, *sq_array{};
+		unsigned *cq_head{}, *cq_tail{}, *cq_mask{};
+		io_uring_sqe* sqes{};
+		io_uring_cqe* cqes{};
+		vector<char> pool;
+
+		//? The buffer pool is kept after a failure, since reads still in flight could write to it until the ring is torn down
+		bool fail(const string& msg) {
+			Logger::warning("io_uring: " + msg + " (" + strerror(errno) + "), using normal reads for process stats.");
+			close_ring();
+			failed = true;
+			return false;
+		}
+
+		void close_ring() {
+			if (sqe_ptr != MAP_FAILED) munmap(sqe_ptr, sqe_len);
+			if (cq_ptr != MAP_FAILED and cq_ptr != sq_ptr) munmap(cq_ptr, cq_len);
+			if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_len);
+			sq_ptr = cq_ptr = sqe_ptr = MAP_FAILED;
+			if (ring_fd >= 0) close(ring_fd);
+			ring_fd = -1;
+		}
+
+		int enter(unsigned to_submit, unsigned min_complete) {
+			return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, IORING_ENTER_GETEVENTS, nullptr, 0);
+		}
+
+	public:
+		static constexpr size_t slot_size = 1024;	// same as collect_buffers::stat
+		static constexpr unsigned batch_size = 2048;
+
+		~stat_ring() { stop(); }
+
+		bool running() const { return ring_fd >= 0; }
+
+		//* Set up ring and buffer pool if not already done, returns false if io_uring isn't available
+		bool start() {
+			if (ring_fd >= 0) return true;
+			if (failed) return false;
+
+			io_uring_params params{};
+			ring_fd = syscall(__NR_io_uring_setup, batch_size, &params);
+			if (ring_fd < 0) return fail("Setup failed");
+			entries = params.sq_entries;
+
+			sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+			if (single_mmap) sq_len = cq_len = max(sq_len, cq_len);
+			sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+			if (sq_ptr == MAP_FAILED) return fail("Failed to map submission ring");
+			cq_ptr = single_mmap ? sq_ptr : mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+			if (cq_ptr == MAP_FAILED) return fail("Failed to map completion ring");
+			sqe_len = params.sq_entries * sizeof(io_uring_sqe);
+			sqe_ptr = mmap(nullptr, sqe_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+			if (sqe_ptr == MAP_FAILED) return fail("Failed to map submission entries");
+
+			auto* sq = (char*)sq_ptr;
+			auto* cq = (char*)cq_ptr;
+			sq_head = (unsigned*)(sq + params.sq_off.head);
+			sq_tail = (unsigned*)(sq + params.sq_off.tail);
+			sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+			sq_array = (unsigned*)(sq + params.sq_off.array);
+			cq_head = (unsigned*)(cq + params.cq_off.head);
+			cq_tail = (unsigned*)(cq + params.cq_off.tail);
+			cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+			sqes = (io_uring_sqe*)sqe_ptr;
+			cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+			//? Registered buffers are pinned once, so the kernel doesn't map the destination for each read
+			pool.resize(entries * slot_size);
+			iovec iov{pool.data(), pool.size()};
+			if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0)
+				return fail("Failed to register buffers");
+			return true;
+		}
+
+		//* Unmap and close ring and release buffer pool
+		void stop() {
+			close_ring();
+			pool.clear();
+			pool.shrink_to_fit();
+		}
+
+		//* Read stat for work entries in [first, last) with a cached descriptor, results are valid until the next call
+		//* Entries that don't fit in the pool are left for the normal path
+		void read(vector<pid_work>& work, size_t first, size_t last) {
+			for (size_t i = first; i < last; i++) {
+				work[i].ring_stat = nullptr;
+				work[i].ring_len = -1;
+			}
+			if (ring_fd < 0) return;
+
+			unsigned tail = std::atomic_ref(*sq_tail).load(std::memory_order_relaxed);
+			unsigned queued = 0;
+			for (size_t i = first; i < last and queued < entries; i++) {
+				auto& w = work[i];
+				if (w.stat_fd < 0) continue;
+				const unsigned idx = tail & *sq_mask;
+				auto& sqe = sqes[idx];
+				sqe = {};
+				sqe.opcode = IORING_OP_READ_FIXED;
+				sqe.fd = w.stat_fd;
+				sqe.addr = (uint64_t)(pool.data() + queued * slot_size);
+				sqe.len = slot_size;
+				sqe.off = 0;
+				sqe.buf_index = 0;
+				sqe.user_data = i;
+				sq_array[idx] = idx;
+				w.ring_stat = pool.data() + queued * slot_size;
+				tail++;
+				queued++;
+			}
+			if (queued == 0) return;
+			std::atomic_ref(*sq_tail).store(tail, std::memory_order_release);
+
+			unsigned submitted = 0, completed = 0;
+			while (completed < queued) {
+				const int ret = enter(queued - submitted, queued - completed);
+				if (ret < 0 and errno != EINTR and errno != EAGAIN and errno != EBUSY) {
+					//? Reads that never completed are redone with pread(), the ring can't be trusted after this
+					for (size_t i = first; i < last; i++) work[i].ring_stat = nullptr;
+					fail("Submit failed");
+					return;
+				}
+				if (ret > 0) submitted += ret;
+
+				unsigned head = std::atomic_ref(*cq_head).load(std::memory_order_relaxed);
+				const unsigned cq_end = std::atomic_ref(*cq_tail).load(std::memory_order_acquire);
+				for (; head != cq_end; head++, completed++) {
+					const auto& cqe = cqes[head & *cq_mask];
+					work[cqe.user_data].ring_len = cqe.res;
+				}
+				std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+			}
+		}
+	};
+
+	//* Reusable buffers for reading per process files, one set for each collecting thread
+	struct collect_buffers {
+		array<char, 64> path;
+		array<char, 1024> stat;
+		ifstream pread;
+		string long_string;
+		string cmd;
+
+		//* Return null terminated path to /proc/[pid]/<file> in path buffer
+		const char* pid_path(size_t pid, std::string_view file) {
+			*fmt::format_to_n(path.data(), path.size() - 1, "{}/{}/{}", Shared::procPath.native(), pid, file).out = '\0';
+			return path.data();
+		}
+
+		//* Return null terminated path to /proc/[pid]/task/[tid]/<file> in path buffer
+		const char* task_path(size_t pid, size_t tid, std::string_view file) {
+			*fmt::format_to_n(path.data(), path.size() - 1, "{}/{}/task/{}/{}", Shared::procPath.native(), pid, tid, file).out = '\0';
+			return path.data();
+		}
+	};
+
+	//* Fixed pool of worker threads used to split the per process work of Proc::collect() in shards
+	class collect_pool {
+		vector<std::thread> threads;
+		std::mutex mtx;
+		std::condition_variable work_cv, done_cv;
+		std::function<void(size_t)> job;
+		atomic<size_t> next_shard{};
+		size_t shards{}, done{};
+		uint64_t generation{};
+		bool quit{};
+
+		//* Threads start at the generation current when they are created, so they only wake for passes started after that
+		void worker(uint64_t last_generation) {
+			std::unique_lock lock(mtx);
+			for (;;) {
+				work_cv.wait(lock, [&] { return quit or generation != last_generation; });
+				if (quit) return;
+				last_generation = generation;
+				lock.unlock();
+				for (size_t shard; (shard = next_shard++) < shards;) job(shard);
+				lock.lock();
+				if (++done == threads.size()) done_cv.notify_one();
+			}
+		}
+
+		void stop() {
+			{
+				std::lock_guard lock(mtx);
+				quit = true;
+			}
+			work_cv.notify_all();
+			for (auto& t : threads) t.join();
+			threads.clear();
+			quit = false;
+		}
+
+	public:
+		~collect_pool() { stop(); }
+
+		//* Run <fn> for every shard in [0, <shard_count>) using <worker_count> threads including the calling thread
+		void run(size_t worker_count, size_t shard_count, std::function<void(size_t)> fn) {
+			if (threads.size() != worker_count - 1) {
+				stop();
+				std::lock_guard lock(mtx);
+				for (size_t i = 1; i < worker_count; i++) threads.emplace_back(&collect_pool::worker, this, generation);
+			}
+			{
+				std::lock_guard lock(mtx);
+				job = std::move(fn);
+				shards = shard_count;
+				next_shard = 0;
+				done = 0;
+				generation++;
+			}
+			work_cv.notify_all();
+			for (size_t shard; (shard = next_shard++) < shards;) job(shard);
+			std::unique_lock lock(mtx);
+			done_cv.wait(lock, [&] { return done == threads.size(); });
+		}
+	};
+
+	collect_pool workers;
+
+	//* Listener for fork, exec and exit events from the kernel proc connector, used to catch processes living shorter than the update interval
+	//* Subscribing needs CAP_NET_ADMIN, events are queued by a background thread and taken at the start of every update
+	namespace Events {
+		enum class type : uint8_t { fork, exec, exit };
+
+		struct event {
+			type what;
+			size_t pid;
+			size_t ppid;	// parent for fork events
+		};
+
+		//* Netlink socket subscribed to the proc connector and the thread reading from it
+		class listener {
+			int sock = -1;
+			bool failed{};
+			std::thread thread;
+			std::mutex mtx;
+			vector<event> pending;
+			atomic<bool> quit{};
+
+			void listen() {
+				alignas(nlmsghdr) array<char, 4096> buf;
+				while (not quit) {
+					ssize_t len = recv(sock, buf.data(), buf.size(), 0);
+					if (len < 0 and (errno == EINTR or errno == EAGAIN or errno == EWOULDBLOCK)) continue;
+					//? Receive buffer overrun, events in between are lost
+					if (len < 0 and errno == ENOBUFS) continue;
+					if (len <= 0) return;
+
+					std::lock_guard lock(mtx);
+					for (auto* hdr = (nlmsghdr*)buf.data(); NLMSG_OK(hdr, len); hdr = NLMSG_NEXT(hdr, len)) {
+						if (hdr->nlmsg_type == NLMSG_ERROR or hdr->nlmsg_type == NLMSG_NOOP) continue;
+						const auto* msg = (const cn_msg*)NLMSG_DATA(hdr);
+						if (msg->id.idx != CN_IDX_PROC or msg->id.val != CN_VAL_PROC) continue;
+						const auto* ev = (const proc_event*)msg->data;
+						switch (ev->what) {
+							case proc_event::PROC_EVENT_FORK:
+								if (ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid)
+									pending.push_back({type::fork, (size_t)ev->event_data.fork.child_tgid, (size_t)ev->event_data.fork.parent_tgid});
+								break;
+							case proc_event::PROC_EVENT_EXEC:
+								pending.push_back({type::exec, (size_t)ev->event_data.exec.process_tgid, 0});
+								break;
+							case proc_event::PROC_EVENT_EXIT:
+								if (ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid)
+									pending.push_back({type::exit, (size_t)ev->event_data.exit.process_tgid, 0});
+								break;
+							default: break;
+						}
+					}
+				}
+			}
+
+			bool fail(const string& msg) {
+				Logger::warning("Proc events: " + msg + " (" + strerror(errno) + "), short lived processes will not be tracked.");
+				if (sock >= 0) close(sock);
+				sock = -1;
+				failed = true;
+				return false;
+			}
+
+		public:
+			~listener() { stop(); }
+
+			//* Subscribe to proc connector events if not already done, returns false if not running
+			bool start() {
+				if (sock >= 0) return true;
+				if (failed) return false;
+
+				sock = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+				if (sock < 0) return fail("Failed to open netlink socket");
+
+				sockaddr_nl addr{};
+				addr.nl_family = AF_NETLINK;
+				addr.nl_groups = CN_IDX_PROC;
+				if (bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0) return fail("Failed to bind netlink socket");
+
+				//? Bursts of short lived processes can produce a lot of events between reads
+				int rcvbuf = 4 << 20;
+				if (setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) < 0)
+					setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+				//? Netlink sockets can't be shut down, so wake up regularly to check if the listener should quit
+				timeval timeout{0, 500'000};
+				setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+				alignas(nlmsghdr) array<char, NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))> req{};
+				auto* hdr = (nlmsghdr*)req.data();
+				hdr->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+				hdr->nlmsg_type = NLMSG_DONE;
+				hdr->nlmsg_pid = getpid();
+				auto* msg = (cn_msg*)NLMSG_DATA(hdr);
+				msg->id.idx = CN_IDX_PROC;
+				msg->id.val = CN_VAL_PROC;
+				msg->len = sizeof(proc_cn_mcast_op);
+				*(proc_cn_mcast_op*)msg->data = PROC_CN_MCAST_LISTEN;
+				if (send(sock, req.data(), hdr->nlmsg_len, 0) < 0) return fail("Failed to subscribe to proc connector");
+
+				//? Started from the runner thread, so the listener inherits its blocked signals
+				quit = false;
+				thread = std::thread(&listener::listen, this);
+				return true;
+			}
+
+			//* Stop listener thread and close socket
+			void stop() {
+				if (sock < 0) return;
+				quit = true;
+				if (thread.joinable()) thread.join();
+				close(sock);
+				sock = -1;
+				std::lock_guard lock(mtx);
+				pending.clear();
+			}
+
+			//* Move all events received since last call to <out>
+			void take(vector<event>& out) {
+				out.clear();
+				std::lock_guard lock(mtx);
+				std::swap(out, pending);
+			}
+		};
+
+		listener proc_events;
+	}
+
+#if !(defined(STATIC_BUILD) && defined(__GLIBC__))
+	//* Names for users not in /etc/passwd are looked up through NSS on a separate thread, since getpwuid() can block
+	//* for seconds with network backed user databases. Collection never waits for it, the uid is shown until resolved
+	namespace Users {
+		using clock = std::chrono::steady_clock;
+
+		//? Time before a failed lookup is retried and time a lookup can run before it's given up on
+		constexpr auto negative_ttl = std::chrono::seconds(60);
+		constexpr auto lookup_timeout = std::chrono::seconds(2);
+		//? Lookups can't be interrupted, stop replacing stuck threads when this many are left hanging
+		constexpr int max_stuck = 4;
+
+		//* Shared with the lookup threads, which are detached and keep it alive since a stuck lookup could block exit
+		struct resolver_state {
+			std::mutex mtx;
+			std::condition_variable cv;
+			deque<uint32_t> queue;
+			vector<std::pair<uint32_t, string>> done;
+			uint64_t worker{};		// id of the thread taking new lookups, 0 if none started
+			bool busy{};
+			uint32_t busy_uid{};
+			clock::time_point busy_since;
+			int stuck{};
+			bool quit{};
+		};
+
+		string lookup(uint32_t uid) {
+			long buf_size = sysconf(_SC_GETPW_R_SIZE_MAX);
+			vector<char> buf(buf_size > 0 ? buf_size : 16384);
+			struct passwd pwd, *result = nullptr;
+			int err;
+			while ((err = getpwuid_r(uid, &pwd, buf.data(), buf.size(), &result)) == ERANGE and buf.size() < (1 << 20))
+				buf.resize(buf.size() * 2);
+			if (err != 0 or result == nullptr or result->pw_name == nullptr) return "";
+			return result->pw_name;
+		}
+
+		void work(std::shared_ptr<resolver_state> s, uint64_t id) {
+			std::unique_lock lock(s->mtx);
+			while (true) {
+				s->cv.wait(lock, [&] { return s->quit or s->worker != id or not s->queue.empty(); });
+				if (s->quit or s->worker != id) return;
+				const uint32_t uid = s->queue.front();
+				s->queue.pop_front();
+				s->busy = true;
+				s->busy_uid = uid;
+				s->busy_since = clock::now();
+
+				lock.unlock();
+				string name = lookup(uid);
+				lock.lock();
+
+				//? A late answer from an abandoned thread is still used
+				s->done.emplace_back(uid, std::move(name));
+				if (s->worker != id) {
+					s->stuck--;
+					return;
+				}
+				s->busy = false;
+			}
+		}
+
+		//* Queues lookups and keeps a negative cache, only used from the runner thread
+		class resolver {
+			std::shared_ptr<resolver_state> s = std::make_shared<resolver_state>();
+			std::unordered_map<uint32_t, clock::time_point> retry_at;
+
+			void start_worker() {
+				s->worker++;
+				s->busy = false;
+				std::thread(work, s, s->worker).detach();
+			}
+
+		public:
+			~resolver() {
+				std::lock_guard lock(s->mtx);
+				s->quit = true;
+				s->cv.notify_all();
+			}
+
+			//* Queue lookup of <uid> unless it's already queued or failed less than negative_ttl ago
+			void request(uint32_t uid) {
+				const auto now = clock::now();
+				if (auto retry = retry_at.find(uid); retry != retry_at.end() and now < retry->second) return;
+				retry_at.insert_or_assign(uid, clock::time_point::max());
+				std::lock_guard lock(s->mtx);
+				s->queue.push_back(uid);
+				if (s->worker == 0) start_worker();
+				s->cv.notify_all();
+			}
+
+			//* Move finished lookups to <out>, the name is empty if the user couldn't be resolved
+			void take(vector<std::pair<uint32_t, string>>& out) {
+				out.clear();
+				const auto now = clock::now();
+				{
+					std::lock_guard lock(s->mtx);
+					std::swap(out, s->done);
+					if (s->busy and now - s->busy_since > lookup_timeout and s->stuck < max_stuck) {
+						out.emplace_back(s->busy_uid, "");
+						s->stuck++;
+						start_worker();
+						s->cv.notify_all();
+					}
+				}
+				for (const auto& [uid, name] : out) {
+					if (name.empty()) retry_at.insert_or_assign(uid, now + negative_ttl);
+					else retry_at.erase(uid);
+				}
+			}
+		};
+
+		resolver user_resolver;
+		std::unordered_set<uint32_t> unresolved;
+		vector<std::pair<uint32_t, string>> resolved;
+	}
+#endif
+
+	//* Get user name for <uid>, /etc/passwd is only read as far as needed to find it
+	user_handle get_user(uint32_t uid) {
+		if (auto user = uid_user.find(uid); user != uid_user.end()) return user->second;
+
+		string r_user, r_uid;
+		while (passwd_file.is_open() and passwd_file.good()) {
+			getline(passwd_file, r_user, ':');
+			passwd_file.ignore(SSmax, ':');
+			getline(passwd_file, r_uid, ':');
+			passwd_file.ignore(SSmax, '\n');
+			uint32_t id{};
+			if (std::from_chars(r_uid.data(), r_uid.data() + r_uid.size(), id).ec != std::errc{}) continue;
+			auto [entry, added] = uid_user.try_emplace(id, r_user);
+			if (id == uid) return entry->second;
+		}
+
+		//? Not in /etc/passwd, the uid is used as name unless the resolver finds one
+	#if !(defined(STATIC_BUILD) && defined(__GLIBC__))
+		Users::unresolved.insert(uid);
+	#endif
+		return uid_user.emplace(uid, to_string(uid)).first->second;
+	}
+
+	//* Max number of processes with deferred names that are loaded each update when not shown or needed
+	constexpr size_t names_backfill = 256;
+
+	//* Rows shown in thread view and the index in current_procs of the process of each row by pid, set by update_threads()
+	vector<proc_info> thread_view;
+	std::unordered_map<size_t, size_t> thread_owners;
+
+	//* Read program name, command and user for <p> if deferred, names stay empty if the process has exited
+	//* Thread view rows take command and user from their process, which is loaded once for all its threads
+	void load_names(proc_info& p) {
+		if (not p.names_pending) return;
+		p.names_pending = false;
+		p.filter_gen = 0;
+
+		if (not thread_view.empty() and &p >= thread_view.data() and &p < thread_view.data() + thread_view.size()) {
+			auto owner = thread_owners.find(p.pid);
+			const bool main_thread = (owner != thread_owners.end());
+			if (not main_thread) owner = thread_owners.find(p.ppid);
+			if (owner == thread_owners.end() or owner->second >= current_procs.size()) return;
+			auto& proc = current_procs[owner->second];
+			load_names(proc);
+			if (main_thread) p.name = proc.name;
+			p.cmd = proc.cmd;
+			p.short_cmd = proc.short_cmd;
+			p.user = proc.user;
+			return;
+		}
+
+		static collect_buffers buf;
+		auto& pread = buf.pread;
+		pread.open(buf.pid_path(p.pid, "comm"));
+		if (not pread.good()) return;
+		getline(pread, p.name);
+		pread.close();
+
+		pread.open(buf.pid_path(p.pid, "cmdline"));
+		if (not pread.good()) return;
+		auto& long_string = buf.long_string;
+		auto& cmd = buf.cmd;
+		long_string.clear();
+		cmd.clear();
+		while(getline(pread, long_string, '\0')) {
+			cmd += long_string + ' ';
+			if (cmd.size() > 1000) {
+				cmd.resize(1000);
+				break;
+			}
+		}
+		pread.close();
+		if (not cmd.empty()) cmd.pop_back();
+		p.cmd = cmd;
+		set_short_cmd(p);
+
+		pread.open(buf.pid_path(p.pid, "status"));
+		if (not pread.good()) return;
+		string line;
+		while (pread.good()) {
+			getline(pread, line, ':');
+			if (line == "Uid") {
+				if (uint32_t uid; pread >> uid) p.user = get_user(uid);
+				break;
+			} else {
+				pread.ignore(SSmax, '\n');
+			}
+		}
+		pread.close();
+	}
+
+	//* Parse contents of /proc/[pid]/stat without allocating, fields are counted from the last ')' since comm can contain both spaces and parentheses
+	bool parse_stat(std::string_view line, pid_stat& out) {
+		const auto comm_end = line.rfind(')');
+		if (comm_end == std::string_view::npos or comm_end + 2 >= line.size()) return false;
+
+		const char* pos = line.data() + comm_end + 2;
+		const char* const end = line.data() + line.size();
+
+		//? State is field 3 and the first field after comm
+		out.state = *pos;
+
+		//? Fields 4 to 24, any field not listed here is skipped without conversion
+		uint64_t stime{}, cutime{};
+		for (int field = 4; field <= 24; field++) {
+			while (pos < end and *pos != ' ') pos++;
+			while (pos < end and *pos == ' ') pos++;
+			if (pos >= end) return false;
+
+			uint64_t* target = nullptr;
+			switch (field) {
+				case 4: target = &out.ppid; break;
+				case 14: target = &out.cpu_t; break;
+				case 15: target = &stime; break;
+				case 16: target = &cutime; break;
+				case 17: target = &out.cpu_children; break;
+				case 19: {
+					int64_t nice{};
+					if (std::from_chars(pos, end, nice).ec != std::errc{}) return false;
+					out.nice = nice;
+					continue;
+				}
+				case 20: target = &out.threads; break;
+				case 22: target = &out.starttime; break;
+				case 24: target = &out.rss; break;
+				default: continue;
+			}
+			if (std::from_chars(pos, end, *target).ec != std::errc{}) return false;
+		}
+		out.cpu_t += stime;
+		out.cpu_children += cutime;
+		return true;
+	}
+
+	//* Read read_bytes and write_bytes from /proc/[pid]/io, using and updating the cached descriptor in <w>
+	//* Returns false if not readable, processes of other users need ptrace access and are marked with io_denied
+	bool read_io(pid_work& w, collect_buffers& buf, uint64_t& read_bytes, uint64_t& write_bytes) {
+		if (w.io_fd == io_denied) return false;
+		ssize_t len = -1;
+		if (w.io_fd >= 0 and (len = ::pread(w.io_fd, buf.stat.data(), buf.stat.size(), 0)) <= 0) {
+			close(w.io_fd);
+			w.io_fd = -1;
+			w.io_fd_changed = true;
+		}
+		if (w.io_fd < 0) {
+			w.io_fd_changed = true;
+			w.io_fd = open(buf.pid_path(w.pid, "io"), O_RDONLY | O_CLOEXEC);
+			if (w.io_fd >= 0 and (len = ::pread(w.io_fd, buf.stat.data(), buf.stat.size(), 0)) <= 0) {
+				close(w.io_fd);
+				w.io_fd = -1;
+			}
+			if (w.io_fd < 0) {
+				if (errno == EACCES or errno == EPERM) w.io_fd = io_denied;
+				return false;
+			}
+		}
+
+		const std::string_view io{buf.stat.data(), (size_t)len};
+		const auto read_pos = io.find("read_bytes: "), write_pos = io.find("write_bytes: ");
+		if (read_pos == std::string_view::npos or write_pos == std::string_view::npos) return false;
+		return std::from_chars(io.data() + read_pos + 12, io.data() + io.size(), read_bytes).ec == std::errc{}
+			and std::from_chars(io.data() + write_pos + 13, io.data() + io.size(), write_bytes).ec == std::errc{};
+	}
+
+	//* Read run time and run queue wait in nanoseconds, returns false if not readable.
+	//* Run time is the process cpu clock, which unlike summing /proc/[pid]/task/[tid]/schedstat keeps the time of exited threads,
+	//* /proc/[pid]/schedstat only covers the main thread and is used for the wait
+	bool read_schedstat(size_t pid, collect_buffers& buf, uint64_t& exec_ns, uint64_t& wait_ns) {
+		clockid_t clock;
+		struct timespec ts;
+		if (clock_getcpuclockid(pid, &clock) != 0 or clock_gettime(clock, &ts) != 0) return false;
+		exec_ns = ts.tv_sec * 1'000'000'000ull + ts.tv_nsec;
+
+		const int fd = open(buf.pid_path(pid, "schedstat"), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) return false;
+		const ssize_t len = ::read(fd, buf.stat.data(), buf.stat.size());
+		close(fd);
+		const char* const end = buf.stat.data() + max(len, (ssize_t)0);
+		uint64_t exec{};
+		const auto first = std::from_chars(buf.stat.data(), end, exec);
+		return first.ec == std::errc{} and std::from_chars(first.ptr + 1, end, wait_ns).ec == std::errc{};
+	}
+
+	//* Read swap and context switches from /proc/[pid]/status and count open files in /proc/[pid]/fd for <p>
+	void read_slow_fields(proc_info& p, double uptime) {
+		static collect_buffers buf;
+		static array<char, 4096> status;
+		static vector<size_t> fds;
+
+		if (const int fd = open(buf.pid_path(p.pid, "status"), O_RDONLY | O_CLOEXEC); fd >= 0) {
+			const ssize_t len = ::read(fd, status.data(), status.size());
+			close(fd);
+			const std::string_view text{status.data(), (size_t)max(len, (ssize_t)0)};
+			auto value = [&](std::string_view key) {
+				uint64_t out{};
+				if (const auto pos = text.find(key); pos != std::string_view::npos) {
+					const auto start = text.find_first_not_of(" \t", pos + key.size());
+					if (start != std::string_view::npos) std::from_chars(text.data() + start, text.data() + text.size(), out);
+				}
+				return out;
+			};
+			p.swap = value("\nVmSwap:") << 10;
+			p.ctx_vol = value("\nvoluntary_ctxt_switches:");
+			p.ctx_invol = value("\nnonvoluntary_ctxt_switches:");
+		}
+
+		//? Listing fd of processes owned by other users needs ptrace access
+		p.fds = (proc_dir.read(buf.pid_path(p.pid, "fd"), fds) ? (int64_t)fds.size() : -1);
+		p.slow_time = uptime;
+	}
+
+	//* Swap, context switches and open files are too slow to read for all processes on every update, they are read for at most <budget>
+	//* processes per update: half for processes that used cpu time or haven't been read yet, oldest first, and the rest in turns by pid
+	void update_slow_fields(vector<proc_info>& procs, size_t budget, double uptime) {
+		static size_t next_pid{};
+		static vector<uint32_t> picks;
+		if (budget == 0) return;
+
+		//? Recently active and new processes
+		picks.clear();
+		for (uint32_t i = 0; i < procs.size(); i++) {
+			if (procs[i].cpu_p > 0.0 or procs[i].slow_time == 0.0) picks.push_back(i);
+		}
+		const size_t active_count = min(picks.size(), max<size_t>(1, budget / 2));
+		rng::nth_element(picks, picks.begin() + active_count, rng::less{}, [&](uint32_t i) { return procs[i].slow_time; });
+		picks.resize(active_count);
+		for (const auto i : picks) read_slow_fields(procs[i], uptime);
+
+		//? Round-robin over the remaining processes, continuing from the pid after the last one read in the previous update
+		picks.clear();
+		for (uint32_t i = 0; i < procs.size(); i++) {
+			if (procs[i].slow_time != uptime) picks.push_back(i);
+		}
+		const size_t turn_count = min(picks.size(), budget - active_count);
+		if (turn_count == 0) return;
+		auto turn_order = [&](uint32_t i) { return std::pair{procs[i].pid < next_pid, procs[i].pid}; };
+		rng::nth_element(picks, picks.begin() + turn_count - 1, rng::less{}, turn_order);
+		next_pid = procs[picks[turn_count - 1]].pid + 1;
+		picks.resize(turn_count);
+		for (const auto i : picks) read_slow_fields(procs[i], uptime);
+	}
+
+	//* Threads of one process from the last scan of /proc/[pid]/task, sorted by tid
+	struct task_cache {
+		uint64_t starttime{};
+		uint64_t cpu_t{};
+		uint64_t threads{};
+		uint64_t generation{};
+		vector<proc_info> tasks;
+	};
+
+	//* Thread caches by pid, only kept while config "proc_threads" is set
+	std::unordered_map<size_t, task_cache> task_caches;
+
+	//* Read /proc/[pid]/task/[tid]/stat for all threads of <proc> into <cache>
+	void scan_tasks(const proc_info& proc, task_cache& cache, uint64_t cpu_delta, int cmult, double uptime) {
+		static collect_buffers buf;
+		static vector<size_t> tids;
+		static vector<proc_info> tasks;
+		tasks.clear();
+		if (not proc_dir.read(buf.pid_path(proc.pid, "task"), tids)) tids.clear();
+
+		for (const size_t tid : tids) {
+			const int fd = open(buf.task_path(proc.pid, tid, "stat"), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) continue;
+			const ssize_t len = ::pread(fd, buf.stat.data(), buf.stat.size(), 0);
+			close(fd);
+			if (len <= 0) continue;
+			const std::string_view line{buf.stat.data(), (size_t)len};
+			pid_stat stat;
+			if (not parse_stat(line, stat)) continue;
+
+			auto& task = tasks.emplace_back(proc_info{tid});
+			const auto comm_start = line.find('(') + 1;
+			task.name = line.substr(comm_start, line.rfind(')') - comm_start);
+			task.state = stat.state;
+			task.p_nice = stat.nice;
+			task.cpu_s = stat.starttime;
+
+			//? Cpu usage since the thread was last scanned, the process hasn't used any cpu time between scans so this covers only the last update
+			const auto old = rng::lower_bound(cache.tasks, tid, rng::less{}, &proc_info::pid);
+			if (old != cache.tasks.end() and old->pid == tid and old->cpu_s == stat.starttime) {
+				task.cpu_p = clamp(round(cmult * 1000 * (stat.cpu_t - min(stat.cpu_t, old->cpu_t)) / max((uint64_t)1, cpu_delta)) / 10.0, 0.0, 100.0 * Shared::coreCount);
+				task.cpu_avg = old->cpu_avg;
+				task.avg_time = old->avg_time;
+			}
+			task.cpu_c = (double)stat.cpu_t / max(1.0, (uptime * Shared::clkTck) - stat.starttime);
+			task.cpu_t = stat.cpu_t;
+		}
+		std::swap(cache.tasks, tasks);
+	}
+
+	//* Build thread_view from the threads of all processes in <procs>, the task directory of a process is only read again
+	//* if its thread count or cpu time changed since last update, otherwise none of its threads has run
+	void update_threads(vector<proc_info>& procs, uint64_t cpu_delta, int cmult, double uptime) {
+		static uint64_t generation{};
+		static std::unordered_set<size_t> collapsed;
+		generation++;
+
+		//? Collapsed state in tree view is kept for rows that still exist
+		collapsed.clear();
+		for (const auto& t : thread_view) {
+			if (t.collapsed) collapsed.insert(t.pid);
+		}
+		thread_view.clear();
+		thread_owners.clear();
+
+		for (auto& p : procs) {
+			thread_owners.emplace(p.pid, &p - procs.data());
+			auto& cache = task_caches[p.pid];
+			cache.generation = generation;
+
+			//? Single threaded processes have one thread with the same stats as the process
+			if (p.threads <= 1) {
+				cache.tasks.assign(1, p);
+			}
+			else if (cache.tasks.empty() or cache.starttime != p.cpu_s or cache.threads != p.threads or cache.cpu_t != p.cpu_t) {
+				scan_tasks(p, cache, cpu_delta, cmult, uptime);
+			}
+			else {
+				for (auto& t : cache.tasks) {
+					t.cpu_p = 0.0;
+					if (t.pid == p.pid) t.state = p.state;
+				}
+			}
+			cache.starttime = p.cpu_s;
+			cache.threads = p.threads;
+			cache.cpu_t = p.cpu_t;
+			if (p.threads > 1) {
+				for (auto& t : cache.tasks) update_cpu_avg(t, uptime);
+			}
+
+			//? Secondary threads are shown as children of the main thread, which takes the place of the process
+			for (const auto& t : cache.tasks) {
+				auto& row = thread_view.emplace_back(t);
+				row.ppid = (t.pid == p.pid ? p.ppid : p.pid);
+				row.cmd = p.cmd;
+				row.short_cmd = p.short_cmd;
+				row.user = p.user;
+				row.mem = p.mem;
+				row.threads = (t.pid == p.pid ? p.threads : 1);
+				row.io_read = (t.pid == p.pid ? p.io_read : 0);
+				row.io_write = (t.pid == p.pid ? p.io_write : 0);
+				if (t.pid == p.pid) {
+					row.swap = p.swap;
+					row.ctx_vol = p.ctx_vol;
+					row.ctx_invol = p.ctx_invol;
+					row.fds = p.fds;
+					row.slow_time = p.slow_time;
+				}
+				row.collapsed = collapsed.contains(t.pid);
+				row.filter_gen = 0;
+				row.names_pending = p.names_pending;
+			}
+		}
+
+		std::erase_if(task_caches, [](const auto& cache) { return cache.second.generation != generation; });
+	}
+
+	//* Processes grouped by cgroup v2 path for cgroup view, groups are kept between updates to follow throttling over time
+	struct cgroup_group {
+		size_t id{};
+		size_t row{};			// position in cgroup_view for the current update
+		size_t procs{};
+		uint64_t generation{};
+		std::optional<uint64_t> throttled_usec;	// from the last update, not set before the first read
+	};
+	std::unordered_map<string, cgroup_group> cgroup_groups;
+	vector<proc_info> cgroup_view;
+
+	//* Read the cgroup v2 path of <p> from /proc/[pid]/cgroup, processes only in v1 hierarchies are put in the root group
+	void load_cgroup(proc_info& p) {
+		static collect_buffers buf;
+		auto& pread = buf.pread;
+		pread.open(buf.pid_path(p.pid, "cgroup"));
+		if (not pread.good()) return;
+		string line, path = "/";
+		while (getline(pread, line)) {
+			if (line.starts_with("0::")) {
+				if (line.size() > 3) path = line.substr(3);
+				break;
+			}
+		}
+		pread.close();
+		p.cgroup = path;
+	}
+
+	//* Read the value of <key> from a flat keyed cgroup file like cpu.stat, or the single value of a file like memory.current if <key> is empty
+	bool read_cgroup_value(const string& file, std::string_view key, uint64_t& out) {
+		static ifstream pread;
+		pread.open(file);
+		if (not pread.good()) return false;
+		string name;
+		bool found{};
+		while (not found and pread.good()) {
+			if (not key.empty()) pread >> name;
+			found = (key.empty() or name == key) and bool(pread >> out);
+			if (not found) pread.ignore(SSmax, '\n');
+		}
+		pread.close();
+		pread.clear();
+		return found;
+	}
+
+	//* Build cgroup_view with one row for each cgroup with processes and for their parent cgroups, cpu, memory and threads are summed from
+	//* the processes, while memory.current, throttling from cpu.stat and oom kills from memory.events are read from the cgroup itself
+	void update_cgroups(vector<proc_info>& procs, double uptime) {
+		static const string cgroup_root = Shared::cgroupPath.string();
+		static uint64_t generation{};
+		static size_t next_id{};
+		static double last_uptime{};
+		static std::unordered_set<size_t> collapsed;
+		static std::unordered_map<const string*, size_t> path_rows;
+		const double elapsed = max(0.001, uptime - last_uptime);
+		last_uptime = uptime;
+		generation++;
+
+		collapsed.clear();
+		for (const auto& g : cgroup_view) {
+			if (g.collapsed) collapsed.insert(g.pid);
+		}
+		cgroup_view.clear();
+
+		//? Rows are added parents first, the pid of a row is the id of its group and the ppid the id of the parent group
+		static vector<string> missing;
+		auto parent_path = [](const string& path) { return (path.rfind('/') == 0 ? "/" : path.substr(0, path.rfind('/'))); };
+		auto add_row = [&](const string& path) -> size_t {
+			missing.clear();
+			for (string cur = path;; cur = parent_path(cur)) {
+				if (const auto found = cgroup_groups.find(cur); found != cgroup_groups.end() and found->second.generation == generation) break;
+				missing.push_back(cur);
+				if (cur == "/" or cur.find('/') == string::npos) break;
+			}
+			for (auto cur = missing.rbegin(); cur != missing.rend(); ++cur) {
+				auto& group = cgroup_groups[*cur];
+				if (group.id == 0) group.id = ++next_id;
+				group.generation = generation;
+				group.procs = 0;
+				group.row = cgroup_view.size();
+
+				auto& row = cgroup_view.emplace_back(proc_info{group.id});
+				if (const auto parent = cgroup_groups.find(parent_path(*cur)); *cur != "/" and parent != cgroup_groups.end())
+					row.ppid = parent->second.id;
+				row.name = (*cur == "/" ? *cur : cur->substr(cur->rfind('/') + 1));
+				row.cgroup = *cur;
+				row.state = 'S';
+				row.collapsed = collapsed.contains(group.id);
+			}
+			return cgroup_groups.at(path).row;
+		};
+
+		//? Interned paths are shared by all processes in the same cgroup, so their address identifies the cgroup
+		path_rows.clear();
+		for (auto& p : procs) {
+			if (p.cgroup.empty()) load_cgroup(p);
+			if (p.cgroup.empty()) continue;
+			auto [found, inserted] = path_rows.try_emplace(&p.cgroup.str());
+			if (inserted) found->second = add_row(p.cgroup.str());
+			auto& row = cgroup_view[found->second];
+			row.cpu_p += p.cpu_p;
+			row.cpu_c += p.cpu_c;
+			row.mem += p.mem;
+			row.threads += p.threads;
+			row.io_read += p.io_read;
+			row.io_write += p.io_write;
+			row.swap += p.swap;
+			row.ctx_vol += p.ctx_vol;
+			row.ctx_invol += p.ctx_invol;
+			if (p.fds > 0) row.fds = max<int64_t>(row.fds, 0) + p.fds;
+			for (size_t i = 0; i < row.cpu_avg.size(); i++) row.cpu_avg[i] += p.cpu_avg[i];
+			row.avg_time = max(row.avg_time, p.avg_time);
+			if (p.sched_time > 0) {
+				row.cpu_wait = min(row.cpu_wait + p.cpu_wait, 100.0);
+				row.sched_time = max(row.sched_time, p.sched_time);
+			}
+			if (p.state == 'R') row.state = 'R';
+			cgroup_groups[p.cgroup.str()].procs++;
+		}
+
+		for (auto& [path, group] : cgroup_groups) {
+			if (group.generation != generation) continue;
+			auto& row = cgroup_view[group.row];
+			const string dir = cgroup_root + (path == "/" ? "" : path);
+			string info = fmt::format("{} [procs: {}", path, group.procs);
+			if (uint64_t current; read_cgroup_value(dir + "/memory.current", "", current))
+				info += ", current: " + floating_humanizer(current, true);
+			//? The first read of a group only sets the starting value, the total since the cgroup was created isn't a rate
+			if (uint64_t throttled; read_cgroup_value(dir + "/cpu.stat", "throttled_usec", throttled)) {
+				if (group.throttled_usec)
+					info += fmt::format(", throttled: {:.1f}%", (double)(throttled - min(throttled, *group.throttled_usec)) / (elapsed * 10'000));
+				group.throttled_usec = throttled;
+			}
+			if (uint64_t oom_kills; read_cgroup_value(dir + "/memory.events", "oom_kill", oom_kills))
+				info += fmt::format(", oom kills: {}", oom_kills);
+			row.cmd = info + ']';
+		}
+
+		std::erase_if(cgroup_groups, [](const auto& group) { return group.second.generation != generation; });
+	}
+
+	//* Processes selected with config "proc_watch" or the --pid and --pgrep options, only these and their descendants are collected
+	struct watch_state {
+		string spec;
+		vector<size_t> roots;			// pids given directly
+		vector<std::regex> patterns;	// matched against the program name like pgrep
+		vector<size_t> matched;			// pids with a matching name found by the last full scan
+		vector<size_t> known;			// pids collected last update
+		double scan_time = -1;
+		bool children_files = true;		// false if the kernel was built without /proc/[pid]/task/[tid]/children
+	} watch;
+
+	//? Seconds between full scans of /proc for new processes matching a pattern, or for new children without children files
+	constexpr double watch_scan_interval = 5.0;
+
+	//* Parse <spec>, numbers are pids and other values are extended regular expressions matched against program names
+	void set_watch(const string& spec) {
+		watch = {};
+		watch.spec = spec;
+		for (const auto& value : ssplit(s_replace(spec, ",", " "))) {
+			if (isint(value)) watch.roots.push_back(stoul(value));
+			else {
+				try { watch.patterns.emplace_back(value, std::regex::extended | std::regex::optimize); }
+				catch (const std::regex_error&) { Logger::warning("Invalid pattern in proc_watch: " + value); }
+			}
+		}
+		rng::sort(watch.roots);
+	}
+
+	//* Read ppid and program name of every process in /proc to find processes matching a pattern and all descendants of the watched processes
+	void watch_full_scan(vector<size_t>& out) {
+		static collect_buffers buf;
+		static vector<size_t> all;
+		static std::unordered_map<size_t, vector<size_t>> children;
+		if (not proc_dir.read(all)) throw std::runtime_error("Failure to read " + Shared::procPath.string());
+
+		children.clear();
+		watch.matched.clear();
+		for (const size_t pid : all) {
+			const int fd = open(buf.pid_path(pid, "stat"), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) continue;
+			const ssize_t len = ::read(fd, buf.stat.data(), buf.stat.size());
+			close(fd);
+			const std::string_view line{buf.stat.data(), (size_t)max(len, (ssize_t)0)};
+			const auto comm_start = line.find('('), comm_end = line.rfind(')');
+			pid_stat stat;
+			if (comm_start == std::string_view::npos or not parse_stat(line, stat)) continue;
+
+			children[stat.ppid].push_back(pid);
+			const string name{line.substr(comm_start + 1, comm_end - comm_start - 1)};
+			if (rng::any_of(watch.patterns, [&](const auto& pattern) { return std::regex_search(name, pattern); }))
+				watch.matched.push_back(pid);
+		}
+
+		//? Walk down from the watched processes, roots given as pids are only included if they still exist
+		out.clear();
+		for (const size_t pid : watch.roots)
+			if (rng::binary_search(all, pid)) out.push_back(pid);
+		out.insert(out.end(), watch.matched.begin(), watch.matched.end());
+		std::unordered_set<size_t> seen(out.begin(), out.end());
+		for (size_t i = 0; i < out.size(); i++) {
+			if (const auto found = children.find(out[i]); found != children.end()) {
+				for (const size_t child : found->second)
+					if (seen.insert(child).second) out.push_back(child);
+			}
+		}
+		rng::sort(out);
+	}
+
+	//* Follow /proc/[pid]/task/[tid]/children down from the watched processes, only the directories of watched processes are read
+	//* Returns false if the kernel doesn't provide children files
+	bool watch_walk(vector<size_t>& out) {
+		static collect_buffers buf;
+		static vector<size_t> queue, tids;
+		queue.assign(watch.roots.begin(), watch.roots.end());
+		queue.insert(queue.end(), watch.matched.begin(), watch.matched.end());
+		std::unordered_set<size_t> seen(queue.begin(), queue.end());
+		out.clear();
+		for (size_t i = 0; i < queue.size(); i++) {
+			const size_t pid = queue[i];
+			if (not proc_dir.read(buf.pid_path(pid, "task"), tids)) continue;
+			out.push_back(pid);
+			for (const size_t tid : tids) {
+				auto& pread = buf.pread;
+				pread.open(buf.task_path(pid, tid, "children"));
+				if (not pread.good()) {
+					pread.clear();
+					if (access(buf.task_path(pid, tid, "stat"), F_OK) == 0) return false;
+					continue;
+				}
+				for (size_t child; pread >> child;)
+					if (seen.insert(child).second) queue.push_back(child);
+				pread.close();
+				pread.clear();
+			}
+		}
+		rng::sort(out);
+		std::erase_if(watch.matched, [&](size_t pid) { return not rng::binary_search(out, pid); });
+		return true;
+	}
+
+	//* Replace <out> with the sorted pids of the watched processes and their descendants
+	void watch_pids(const string& spec, double uptime, vector<size_t>& out) {
+		if (spec != watch.spec) set_watch(spec);
+		const bool scan_due = (watch.scan_time < 0 or uptime - watch.scan_time >= watch_scan_interval);
+		if (scan_due and (watch.scan_time < 0 or not watch.patterns.empty() or not watch.children_files)) {
+			watch_full_scan(out);
+			watch.scan_time = uptime;
+		}
+		else if (not watch.children_files or not (watch.children_files = watch_walk(out))) {
+			//? Without children files new children are found by the next full scan, known processes are kept while they exist
+			static collect_buffers buf;
+			out.clear();
+			for (const size_t pid : watch.known)
+				if (access(buf.pid_path(pid, "stat"), F_OK) == 0) out.push_back(pid);
+		}
+		watch.known = out;
+	}
+
+	//* Replace <out> with the sorted pids in cgroup.procs of <dir> and all cgroups below it
+	void scope_pids(const fs::path& dir, vector<size_t>& out) {
+		static ifstream pread;
+		out.clear();
+		std::error_code ec;
+		auto read_procs = [&](const fs::path& cgroup) {
+			pread.open(cgroup / "cgroup.procs");
+			for (size_t pid; pread >> pid;) out.push_back(pid);
+			pread.close();
+			pread.clear();
+		};
+		read_procs(dir);
+		for (auto it = fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied, ec); not ec and it != fs::recursive_directory_iterator(); it.increment(ec)) {
+			if (it->is_directory(ec)) read_procs(it->path());
+		}
+
+		//? Processes moved between cgroups during the walk can be listed twice
+		rng::sort(out);
+		out.erase(std::unique(out.begin(), out.end()), out.end());
+	}
+
 	//* Get detailed info for selected process
 	void _collect_details(const size_t pid, const uint64_t uptime, vector<proc_info>& procs) {
 		fs::path pid_path = Shared::procPath / std::to_string(pid);
@@ -2554,6 +3936,8 @@ namespace Proc {
 
 		//? Copy proc_info for process from proc vector
 		auto p_info = rng::find(procs, pid, &proc_info::pid);
+		if (p_info == procs.end()) return;
+		load_names(*p_info);
 		detailed.entry = *p_info;
 
 		//? Update cpu percent deque for process cpu graph
@@ -2568,7 +3952,10 @@ namespace Proc {
 		//? Get parent process name
 		if (detailed.parent.empty()) {
 			auto p_entry = rng::find(procs, detailed.entry.ppid, &proc_info::pid);
-			if (p_entry != procs.end()) detailed.parent = p_entry->name;
+			if (p_entry != procs.end()) {
+				load_names(*p_entry);
+				detailed.parent = p_entry->name;
+			}
 		}
 
 		//? Expand process status from single char to explanative string
@@ -2577,9 +3964,39 @@ namespace Proc {
 		ifstream d_read;
 		string short_str;
 
-		//? Try to get RSS mem from proc/[pid]/smaps
+		//? Get Rss, Pss, Uss (private pages) and Swap from proc/[pid]/smaps_rollup, summed up by the kernel and read in one small read
 		detailed.memory.clear();
-		if (not detailed.skip_smaps and fs::exists(pid_path / "smaps")) {
+		detailed.mem_details.clear();
+		if (not detailed.skip_rollup) {
+			d_read.open(pid_path / "smaps_rollup");
+			uint64_t rss{}, pss{}, uss{}, swap{};
+			bool found{};
+			string line;
+			while (getline(d_read, line)) {
+				const auto sep = line.find(':');
+				if (sep == string::npos) continue;
+				const std::string_view key{line.data(), sep};
+				uint64_t* target = (key == "Rss" ? &rss : key == "Pss" ? &pss : key == "Swap" ? &swap
+					: (key == "Private_Clean" or key == "Private_Dirty") ? &uss : nullptr);
+				if (target == nullptr) continue;
+				const auto start = line.find_first_not_of(' ', sep + 1);
+				if (uint64_t value; start != string::npos and std::from_chars(line.data() + start, line.data() + line.size(), value).ec == std::errc{}) {
+					*target += value;
+					found |= (target == &pss);
+				}
+			}
+			d_read.close();
+			if (found) {
+				detailed.mem_bytes.push_back(pss << 10);
+				detailed.memory = floating_humanizer(pss, false, 1);
+				detailed.mem_details = "Rss " + floating_humanizer(rss, true, 1) + " Uss " + floating_humanizer(uss, true, 1)
+					+ " Swap " + floating_humanizer(swap, true, 1);
+			}
+			else detailed.skip_rollup = true;
+		}
+
+		//? Try to get RSS mem from proc/[pid]/smaps
+		if (detailed.memory.empty() and not detailed.skip_smaps and fs::exists(pid_path / "smaps")) {
 			d_read.open(pid_path / "smaps");
 			uint64_t rss = 0;
 			try {
@@ -2648,8 +4065,14 @@ namespace Proc {
 		auto per_core = Config::getB("proc_per_core");
 		auto should_filter_kernel = Config::getB("proc_filter_kernel");
 		auto tree = Config::getB("proc_tree");
+		auto cgroups = Config::getB("proc_cgroups");
+		auto threads = Config::getB("proc_threads") and not cgroups;
 		auto show_detailed = Config::getB("show_detailed");
 		const size_t detailed_pid = Config::getI("detailed_pid");
+		const auto& scope = Shared::scope_dir();
+		const bool schedstat = Config::getB("proc_schedstat");
+		const auto& watch_spec = (Config::getS("watch_arg").empty() ? Config::getS("proc_watch") : Config::getS("watch_arg"));
+		const bool watching = scope.empty() and not watch_spec.empty();
 		bool should_filter = current_filter != filter;
 		if (should_filter) current_filter = filter;
 		bool sorted_change = (sorting != current_sort or reverse != current_rev or should_filter);
@@ -2658,10 +4081,10 @@ namespace Proc {
 			current_rev = reverse;
 		}
 		ifstream pread;
-		string long_string;
-		string short_str;
 
-		static vector<size_t> found;
+		//? Sorted pids from this and the previous update
+		static vector<size_t> pids, last_pids, born, died;
+		static vector<uint8_t> remove;
 
 		const double uptime = system_uptime();
 
@@ -2670,14 +4093,21 @@ namespace Proc {
 
 		static size_t proc_clear_count{};
 
+		//? Rows to filter, sort and show, one per thread in thread view and one per cgroup in cgroup view
+		auto& shown = (cgroups ? cgroup_view : threads ? thread_view : current_procs);
+
 		//* Use pids from last update if only changing filter, sorting or tree options
-		if (no_update and not current_procs.empty()) {
-			if (show_detailed and detailed_pid != detailed.last_pid) _collect_details(detailed_pid, round(uptime), current_procs);
+		if (no_update and not shown.empty()) {
+			if (show_detailed and detailed_pid != detailed.last_pid) _collect_details(detailed_pid, round(uptime), shown);
 		}
 		//* ---------------------------------------------Collection start----------------------------------------------
 		else {
 			should_filter = true;
-			found.clear();
+
+			//? Rebuild pid index since sorting moves entries around in current_procs
+			pid_index.clear();
+			for (size_t i = 0; i < current_procs.size(); i++)
+				pid_index.emplace(current_procs[i].pid, i);
 
 			//? First make sure kernel proc cache is cleared.
 			if (should_filter_kernel and ++proc_clear_count >= 256) {
@@ -2688,31 +4118,82 @@ namespace Proc {
 				proc_clear_count = 0;
 			}
 
+			//? Take process events received since last update, pids are matched against the entries from last update
+			const bool proc_events = Config::getB("proc_events");
+			static vector<Events::event> events;
+			static std::unordered_set<size_t> exec_pids;
+			static std::unordered_map<size_t, size_t> fork_parents;
+			exec_pids.clear();
+			fork_parents.clear();
+			size_t exited_unseen{};
+			if (proc_events and Events::proc_events.start()) {
+				Events::proc_events.take(events);
+				for (const auto& e : events) {
+					switch (e.what) {
+						case Events::type::fork: fork_parents.insert_or_assign(e.pid, e.ppid); break;
+						case Events::type::exec: exec_pids.insert(e.pid); break;
+						case Events::type::exit: if (scope.empty() and not watching and not pid_index.contains(e.pid) and not kernels_procs.contains(e.pid)) exited_unseen++; break;
+					}
+				}
+			}
+			else if (not proc_events) {
+				Events::proc_events.stop();
+			}
+
 			auto totalMem = Mem::get_totalMem();
-			int totalMem_len = to_string(totalMem >> 10).size();
 
-			//? Update uid_user map if /etc/passwd changed since last run
+			//? Keep at most half of the allowed open files as cached stat descriptors
+			static const size_t nofile_max = [] {
+				struct rlimit limit;
+				return (getrlimit(RLIMIT_NOFILE, &limit) == 0 and limit.rlim_cur != RLIM_INFINITY ? limit.rlim_cur / 2 : 1024);
+			}();
+			const size_t fd_cache_max = min((size_t)Config::getI("proc_fd_cache"), nofile_max);
+
+			//? Disk io rates are only read while shown or sorted on, the first update after enabling only sets the starting values
+			const bool collect_io = sorting.starts_with("io ") or Config::getS("proc_columns").find("io_") != string::npos;
+			static bool io_collected{};
+			static double io_uptime{};
+			const bool io_baseline = collect_io and not io_collected;
+			const double io_elapsed = max(0.001, uptime - io_uptime);
+
+			//? Half of the descriptor cache is used for io descriptors while io rates are collected
+			const size_t io_cache_max = (collect_io ? fd_cache_max / 2 : 0);
+			const size_t stat_cache_max = fd_cache_max - io_cache_max;
+			while (stat_fds.size() > stat_cache_max) close_stat_fd(stat_fds.begin()->first);
+			while (io_fds.size() > io_cache_max) close_io_fd(io_fds.begin()->first);
+
+			//? Reset uid_user map if /etc/passwd changed since last run, the file is read again as uids are looked up
 			if (not Shared::passwd_path.empty() and fs::last_write_time(Shared::passwd_path) != passwd_time) {
-				string r_uid, r_user;
 				passwd_time = fs::last_write_time(Shared::passwd_path);
 				uid_user.clear();
-				pread.open(Shared::passwd_path);
-				if (pread.good()) {
-					while (pread.good()) {
-						getline(pread, r_user, ':');
-						pread.ignore(SSmax, ':');
-						getline(pread, r_uid, ':');
-						if (uid_user.contains(r_uid)) break;
-						uid_user[r_uid] = r_user;
-						pread.ignore(SSmax, '\n');
-					}
-				}
-				else {
+				passwd_file.close();
+				passwd_file.clear();
+				passwd_file.open(Shared::passwd_path);
+				if (not passwd_file.good()) {
+					passwd_file.close();
 					Shared::passwd_path.clear();
 				}
-				pread.close();
 			}
 
+		#if !(defined(STATIC_BUILD) && defined(__GLIBC__))
+			//? Use names found by the resolver since last run and retry failed lookups when their negative cache entry expires
+			if (not Users::unresolved.empty()) {
+				for (const auto uid : Users::unresolved) Users::user_resolver.request(uid);
+				Users::user_resolver.take(Users::resolved);
+				for (const auto& [uid, name] : Users::resolved) {
+					if (name.empty() or not Users::unresolved.contains(uid)) continue;
+					Users::unresolved.erase(uid);
+					const user_handle numeric = to_string(uid), user = name;
+					uid_user.insert_or_assign(uid, user);
+					for (auto& p : current_procs) {
+						if (p.user != numeric) continue;
+						p.user = user;
+						p.filter_gen = 0;
+					}
+				}
+			}
+		#endif
+
 			//? Get cpu total times from /proc/stat
 			cputimes = 0;
 			pread.open(Shared::procPath / "stat");
@@ -2723,166 +4204,139 @@ namespace Proc {
 			else throw std::runtime_error("Failure to read /proc/stat");
 			pread.close();
 
-			//? Iterate over all pids in /proc
-			for (const auto& d: fs::directory_iterator(Shared::procPath)) {
-				if (Runner::stopping)
-					return current_procs;
-
-				if (pread.is_open()) pread.close();
-
-				const string pid_str = d.path().filename();
-				if (not isdigit(pid_str[0])) continue;
-
-				const size_t pid = stoul(pid_str);
+			//? List pids in /proc, or only the processes of the cgroup scope or the watched processes, and compare with last update to find new and exited processes
+			std::swap(pids, last_pids);
+			if (not scope.empty()) scope_pids(scope, pids);
+			else if (watching) watch_pids(watch_spec, uptime, pids);
+			else if (not proc_dir.read(pids)) throw std::runtime_error("Failure to read " + Shared::procPath.string());
+			diff_pids(last_pids, pids, born, died);
+
+			//? Entries to remove from current_procs, marked for exited processes and kernel processes if filtered
+			const size_t old_size = current_procs.size();
+			current_procs.reserve(old_size + born.size());
+			remove.assign(old_size, false);
+			for (const size_t pid : died) {
+				if (auto index = pid_index.find(pid); index != pid_index.end()) remove[index->second] = true;
+			}
 
+			//? Iterate over all pids in /proc and match them against current_procs
+			static vector<pid_work> work;
+			work.clear();
+			for (const size_t pid : pids) {
 				if (should_filter_kernel and kernels_procs.contains(pid)) {
+					if (auto index = pid_index.find(pid); index != pid_index.end()) remove[index->second] = true;
 					continue;
 				}
 
-				found.push_back(pid);
-
 				//? Check if pid already exists in current_procs
-				auto find_old = rng::find(current_procs, pid, &proc_info::pid);
-				bool no_cache{};
-				if (find_old == current_procs.end()) {
-					current_procs.push_back({pid});
-					find_old = current_procs.end() - 1;
-					no_cache = true;
-				}
+				const auto [index, inserted] = pid_index.try_emplace(pid, current_procs.size());
+				if (inserted) current_procs.push_back({pid});
 
-				auto& new_proc = *find_old;
+				const auto cached_fd = stat_fds.find(pid);
+				auto& w = work.emplace_back(pid_work{pid, index->second, (cached_fd != stat_fds.end() ? cached_fd->second : -1), inserted});
+				if (collect_io) {
+					if (const auto cached_io = io_fds.find(pid); cached_io != io_fds.end()) w.io_fd = cached_io->second;
+				}
 
-				//? Get program name, command and username
-				if (no_cache) {
-					pread.open(d.path() / "comm");
-					if (not pread.good()) continue;
-					getline(pread, new_proc.name);
-					pread.close();
-					//? Check for whitespace characters in name and set offset to get correct fields from stat file
-					new_proc.name_offset = rng::count(new_proc.name, ' ');
-
-					pread.open(d.path() / "cmdline");
-					if (not pread.good()) continue;
-					long_string.clear();
-					while(getline(pread, long_string, '\0')) {
-						new_proc.cmd += long_string + ' ';
-						if (new_proc.cmd.size() > 1000) {
-							new_proc.cmd.resize(1000);
-							break;
-						}
+				if (not proc_events) continue;
+
+				//? Processes forked since last update that haven't called exec are running the same program as their parent
+				if (inserted and not exec_pids.contains(pid)) {
+					const auto parent = fork_parents.find(pid);
+					const auto p_index = (parent != fork_parents.end() ? pid_index.find(parent->second) : pid_index.end());
+					if (p_index != pid_index.end() and p_index->second < index->second and not exec_pids.contains(parent->second)
+					and not current_procs[p_index->second].names_pending and not current_procs[p_index->second].name.empty()) {
+						auto& new_proc = current_procs[index->second];
+						const auto& parent_proc = current_procs[p_index->second];
+						new_proc.name = parent_proc.name;
+						new_proc.cmd = parent_proc.cmd;
+						new_proc.short_cmd = parent_proc.short_cmd;
+						new_proc.user = parent_proc.user;
+						w.names_known = true;
 					}
-					pread.close();
-					if (not new_proc.cmd.empty()) new_proc.cmd.pop_back();
-
-					pread.open(d.path() / "status");
-					if (not pread.good()) continue;
-					string uid;
-					string line;
-					while (pread.good()) {
-						getline(pread, line, ':');
-						if (line == "Uid") {
-							pread.ignore();
-							getline(pread, uid, '\t');
-							break;
-						} else {
-							pread.ignore(SSmax, '\n');
-						}
+				}
+				else if (not inserted and exec_pids.contains(pid)) {
+					w.exec = true;
+				}
+			}
+			//? Pids that weren't born can still be new to current_procs, e.g. kernel processes let back in when kernels_procs is reset
+			remove.resize(current_procs.size(), false);
+
+			//* Read and parse files for one process, only touches <w> and its own entry in current_procs so it can run on any thread
+			auto collect_pid = [&](pid_work& w, collect_buffers& buf) {
+				auto& new_proc = current_procs[w.index];
+				auto& pread = buf.pread;
+
+				//? Parse /proc/[pid]/stat, using the cached descriptor if one is open for this pid
+				ssize_t stat_len = -1;
+				const char* stat_data = buf.stat.data();
+				if (w.stat_fd >= 0) {
+					if (w.ring_stat != nullptr) {
+						stat_data = w.ring_stat;
+						stat_len = w.ring_len;
 					}
-					pread.close();
-					if (uid_user.contains(uid)) {
-						new_proc.user = uid_user.at(uid);
+					else stat_len = ::pread(w.stat_fd, buf.stat.data(), buf.stat.size(), 0);
+					if (stat_len <= 0) {
+						close(w.stat_fd);
+						w.stat_fd = -1;
+						w.fd_changed = true;
 					}
-					else {
-					#if !(defined(STATIC_BUILD) && defined(__GLIBC__))
-						try {
-							struct passwd* udet;
-							udet = getpwuid(stoi(uid));
-							if (udet != nullptr and udet->pw_name != nullptr) {
-								new_proc.user = string(udet->pw_name);
-							}
-							else {
-								new_proc.user = uid;
-							}
-						}
-						catch (...) { new_proc.user = uid; }
-					#else
-						new_proc.user = uid;
-					#endif
+				}
+				if (w.stat_fd < 0) {
+					w.fd_changed = true;
+					stat_data = buf.stat.data();
+					w.stat_fd = open(buf.pid_path(w.pid, "stat"), O_RDONLY | O_CLOEXEC);
+					if (w.stat_fd >= 0 and (stat_len = ::pread(w.stat_fd, buf.stat.data(), buf.stat.size(), 0)) <= 0) {
+						close(w.stat_fd);
+						w.stat_fd = -1;
 					}
 				}
+				pid_stat stat;
+				if (stat_len <= 0 or not parse_stat({stat_data, (size_t)stat_len}, stat)) return;
 
-				//? Parse /proc/[pid]/stat
-				pread.open(d.path() / "stat");
-				if (not pread.good()) continue;
-
-				const auto& offset = new_proc.name_offset;
-				short_str.clear();
-				int x = 0, next_x = 3;
-				uint64_t cpu_t = 0;
-				try {
-					for (;;) {
-						while (pread.good() and ++x < next_x + offset) pread.ignore(SSmax, ' ');
-						if (not pread.good()) break;
-						else getline(pread, short_str, ' ');
-
-						switch (x-offset) {
-							case 3: //? Process state
-								new_proc.state = short_str.at(0);
-								if (new_proc.ppid != 0) next_x = 14;
-								continue;
-							case 4: //? Parent pid
-								new_proc.ppid = stoull(short_str);
-								next_x = 14;
-								continue;
-							case 14: //? Process utime
-								cpu_t = stoull(short_str);
-								continue;
-							case 15: //? Process stime
-								cpu_t += stoull(short_str);
-								next_x = 19;
-								continue;
-							case 19: //? Nice value
-								new_proc.p_nice = stoll(short_str);
-								continue;
-							case 20: //? Number of threads
-								new_proc.threads = stoull(short_str);
-								if (new_proc.cpu_s == 0) {
-									next_x = 22;
-									new_proc.cpu_t = cpu_t;
-								}
-								else
-									next_x = 24;
-								continue;
-							case 22: //? Get cpu seconds if missing
-								new_proc.cpu_s = stoull(short_str);
-								next_x = 24;
-								continue;
-							case 24: //? RSS memory (can be inaccurate, but parsing smaps increases total cpu usage by ~20x)
-								if (cmp_greater(short_str.size(), totalMem_len))
-									new_proc.mem = totalMem;
-								else
-									new_proc.mem = stoull(short_str) * Shared::pageSize;
-						}
-						break;
-					}
+				//? A different start time means the pid has been reused by a new process since last update
+				if (not w.no_cache and new_proc.cpu_s != stat.starttime) {
+					new_proc = {w.pid};
+					w.no_cache = true;
+				}
 
+				//? Cpu time of children reaped since last update, used to account for processes that never showed up in an update
+				if (not w.no_cache) w.children_delta = stat.cpu_children - min(stat.cpu_children, new_proc.cpu_children);
+				w.last_children = new_proc.cpu_children;
+				new_proc.cpu_children = stat.cpu_children;
+
+				//? Program name, command and user of new processes or if the program has changed are read later with load_names(),
+				//? and only for processes that are shown or needed by the filter or sorting
+				if ((w.no_cache or w.exec) and not w.names_known) {
+					new_proc.name.clear();
+					new_proc.cmd.clear();
+					new_proc.short_cmd.clear();
+					new_proc.filter_gen = 0;
+					new_proc.names_pending = true;
 				}
-				catch (const std::invalid_argument&) { continue; }
-				catch (const std::out_of_range&) { continue; }
 
-				pread.close();
+				new_proc.state = stat.state;
+				new_proc.ppid = stat.ppid;
+				new_proc.p_nice = stat.nice;
+				new_proc.threads = stat.threads;
+				if (new_proc.cpu_s == 0) {
+					new_proc.cpu_s = stat.starttime;
+					new_proc.cpu_t = stat.cpu_t;
+				}
+				const uint64_t cpu_t = stat.cpu_t;
 
 				if (should_filter_kernel and new_proc.ppid == KTHREADD) {
-					kernels_procs.emplace(new_proc.pid);
-					found.pop_back();
+					w.kernel = true;
+					return;
 				}
 
-				if (x-offset < 24) continue;
+				//? RSS memory (can be inaccurate, but parsing smaps increases total cpu usage by ~20x)
+				new_proc.mem = (stat.rss > totalMem / Shared::pageSize ? totalMem : stat.rss * Shared::pageSize);
 
 				//? Get RSS memory from /proc/[pid]/statm if value from /proc/[pid]/stat looks wrong
 				if (new_proc.mem >= totalMem) {
-					pread.open(d.path() / "statm");
-					if (not pread.good()) continue;
+					pread.open(buf.pid_path(w.pid, "statm"));
+					if (not pread.good()) return;
 					pread.ignore(SSmax, ' ');
 					pread >> new_proc.mem;
 					new_proc.mem *= Shared::pageSize;
@@ -2895,21 +4349,193 @@ namespace Proc {
 				//? Process cumulative cpu usage since process start
 				new_proc.cpu_c = (double)cpu_t / max(1.0, (uptime * Shared::clkTck) - new_proc.cpu_s);
 
+				//? Disk io rates, a process that hasn't used any cpu time since last update can't have started any io and isn't read,
+				//? the bytes and time of the last read are kept so the next rate covers the whole time since then
+				//? New processes started during the last interval, other processes only set the starting values on their first read
+				if (collect_io) {
+					uint64_t read_bytes{}, write_bytes{};
+					if ((io_baseline or w.no_cache or cpu_t != new_proc.cpu_t) and read_io(w, buf, read_bytes, write_bytes)) {
+						const bool has_last = not io_baseline and (w.no_cache or new_proc.io_time > 0);
+						const double elapsed = (new_proc.io_time > 0 ? max(0.001, uptime - new_proc.io_time) : io_elapsed);
+						new_proc.io_read = (has_last ? (read_bytes - min(read_bytes, new_proc.io_read_bytes)) / elapsed : 0);
+						new_proc.io_write = (has_last ? (write_bytes - min(write_bytes, new_proc.io_write_bytes)) / elapsed : 0);
+						new_proc.io_read_bytes = read_bytes;
+						new_proc.io_write_bytes = write_bytes;
+						new_proc.io_time = uptime;
+					}
+					else {
+						new_proc.io_read = new_proc.io_write = 0;
+					}
+				}
+
+				//? Cpu usage from nanosecond run time over the monotonic time between reads, the first read only sets the starting values
+				if (schedstat) {
+					uint64_t exec_ns{}, wait_ns{};
+					struct timespec ts;
+					clock_gettime(CLOCK_MONOTONIC, &ts);
+					const uint64_t now = ts.tv_sec * 1'000'000'000ull + ts.tv_nsec;
+					if (read_schedstat(w.pid, buf, exec_ns, wait_ns)) {
+						if (not w.no_cache and new_proc.sched_time > 0 and now > new_proc.sched_time) {
+							const double elapsed = now - new_proc.sched_time;
+							new_proc.cpu_p = clamp(round(cmult * 1000 * (exec_ns - min(exec_ns, new_proc.exec_ns)) / (elapsed * Shared::coreCount)) / 10.0, 0.0, 100.0 * Shared::coreCount);
+							new_proc.cpu_wait = clamp(round(1000 * (wait_ns - min(wait_ns, new_proc.wait_ns)) / elapsed) / 10.0, 0.0, 100.0);
+						}
+						new_proc.exec_ns = exec_ns;
+						new_proc.wait_ns = wait_ns;
+						new_proc.sched_time = now;
+					}
+				}
+				else if (new_proc.sched_time != 0) {
+					new_proc.sched_time = 0;
+					new_proc.cpu_wait = 0;
+				}
+
+				update_cpu_avg(new_proc, uptime);
+
 				//? Update cached value with latest cpu times
+				w.last_cpu_t = new_proc.cpu_t;
 				new_proc.cpu_t = cpu_t;
 
-				if (show_detailed and not got_detailed and new_proc.pid == detailed_pid) {
+				w.valid = true;
+			};
+
+			//? Split work in shards over the worker threads when enabled, results only depend on the work list so the outcome is the same for any number of threads
+			const size_t worker_count = (Config::getI("proc_collect_workers") > 0
+				? Config::getI("proc_collect_workers")
+				: clamp<size_t>(work.size() / 2048 + 1, 1, Shared::coreCount));
+			auto collect_range = [&](size_t first, size_t last) {
+				if (worker_count > 1 and last - first > worker_count) {
+					const size_t shard_count = worker_count * 4;
+					const size_t shard_size = (last - first + shard_count - 1) / shard_count;
+					workers.run(worker_count, shard_count, [&](size_t shard) {
+						thread_local collect_buffers buf;
+						for (size_t i = first + shard * shard_size; i < min(last, first + (shard + 1) * shard_size) and not Runner::stopping; i++)
+							collect_pid(work[i], buf);
+					});
+				}
+				else {
+					thread_local collect_buffers buf;
+					for (size_t i = first; i < last and not Runner::stopping; i++)
+						collect_pid(work[i], buf);
+				}
+			};
+
+			//? With io_uring enabled the cached stat descriptors are read in batches before each batch is processed
+			static stat_ring ring;
+			if (Config::getB("proc_io_uring") and not stat_fds.empty() and ring.start()) {
+				for (size_t first = 0; first < work.size() and not Runner::stopping; first += stat_ring::batch_size) {
+					const size_t last = min(work.size(), first + stat_ring::batch_size);
+					ring.read(work, first, last);
+					collect_range(first, last);
+				}
+			}
+			else {
+				if (ring.running()) ring.stop();
+				collect_range(0, work.size());
+			}
+			//? Descriptors replaced by the collecting threads are updated in the caches even if the update is dropped below,
+			//? the old ones are already closed, and descriptors of new processes dropped with the update are closed
+			const bool dropped = Runner::stopping;
+			for (auto& w : work) {
+				const bool keep = not (dropped and w.index >= old_size);
+				if (w.fd_changed) {
+					stat_fds.erase(w.pid);
+					if (w.stat_fd >= 0 and keep and stat_fds.size() < stat_cache_max)
+						stat_fds.emplace(w.pid, w.stat_fd);
+					else if (w.stat_fd >= 0)
+						close(w.stat_fd);
+				}
+
+				if (w.io_fd_changed) {
+					io_fds.erase(w.pid);
+					if (w.io_fd != -1 and keep and io_fds.size() < io_cache_max)
+						io_fds.emplace(w.pid, w.io_fd);
+					else if (w.io_fd >= 0)
+						close(w.io_fd);
+				}
+			}
+
+			//? Drop the partial update, pids and cpu times are restored so the next update covers the whole time since the last full one
+			//? and processes that exited meanwhile are still removed next time
+			if (dropped) {
+				for (const auto& w : work) {
+					if (not w.valid or w.index >= old_size) continue;
+					current_procs[w.index].cpu_t = w.last_cpu_t;
+					current_procs[w.index].cpu_children = w.last_children;
+				}
+				current_procs.resize(old_size);
+				std::swap(pids, last_pids);
+				return current_procs;
+			}
+
+			//? Merge results in order of the work list
+			uint64_t reaped_cpu{};
+			for (auto& w : work) {
+				reaped_cpu += w.children_delta;
+
+				if (w.kernel) {
+					kernels_procs.emplace(w.pid);
+					remove[w.index] = true;
+					continue;
+				}
+
+				if (show_detailed and not got_detailed and w.valid and w.pid == detailed_pid) {
 					got_detailed = true;
 				}
 			}
 
 			//? Clear dead processes from current_procs and remove kernel processes if enabled
-			auto eraser = rng::remove_if(current_procs, [&](const auto& element){ return not v_contains(found, element.pid); });
-			current_procs.erase(eraser.begin(), eraser.end());
+			uint64_t dead_cpu{};
+			size_t kept = 0;
+			for (size_t i = 0; i < current_procs.size(); i++) {
+				if (remove[i]) {
+					close_stat_fd(current_procs[i].pid);
+					close_io_fd(current_procs[i].pid);
+					if (not kernels_procs.contains(current_procs[i].pid)) dead_cpu += current_procs[i].cpu_t + current_procs[i].cpu_children;
+					continue;
+				}
+				if (kept != i) current_procs[kept] = std::move(current_procs[i]);
+				kept++;
+			}
+			current_procs.resize(kept);
+
+			//? Processes that both started and exited since last update, the proc connector doesn't report cpu usage on exit,
+			//? so cpu time is taken from what parents gained in reaped children minus what was last seen for known dead processes
+			if (proc_events) {
+				transient.count = exited_unseen;
+				transient.cpu_p = clamp(round(cmult * 1000 * (double)(reaped_cpu - min(reaped_cpu, dead_cpu)) / max((uint64_t)1, cputimes - old_cputimes)) / 10.0, 0.0, 100.0 * Shared::coreCount);
+			}
+
+			//? Swap, context switches and open files for a limited number of processes while shown
+			if (const auto& columns = Config::getS("proc_columns"); columns.find("swap") != string::npos or columns.find("ctx_") != string::npos
+			or columns.find("fds") != string::npos or columns.find("age") != string::npos) {
+				update_slow_fields(current_procs, Config::getI("proc_slow_budget"), uptime);
+			}
+
+			//? Thread view rows, or release the thread caches if thread view is off
+			if (threads) {
+				update_threads(current_procs, cputimes - old_cputimes, cmult, uptime);
+				got_detailed = (show_detailed and rng::find(thread_view, detailed_pid, &proc_info::pid) != thread_view.end());
+			}
+			else if (not thread_view.empty()) {
+				thread_view = {};
+				thread_owners.clear();
+				task_caches.clear();
+			}
+
+			//? Cgroup view rows, processes keep their cgroup path when turned off since it's only read once for each process
+			if (cgroups) {
+				update_cgroups(current_procs, uptime);
+				got_detailed = false;
+			}
+			else if (not cgroup_view.empty()) {
+				cgroup_view = {};
+				cgroup_groups.clear();
+			}
 
 			//? Update the details info box for process if active
 			if (show_detailed and got_detailed) {
-				_collect_details(detailed_pid, round(uptime), current_procs);
+				_collect_details(detailed_pid, round(uptime), shown);
 			}
 			else if (show_detailed and not got_detailed and detailed.status != "Dead") {
 				detailed.status = "Dead";
@@ -2917,13 +4543,20 @@ namespace Proc {
 			}
 
 			old_cputimes = cputimes;
+			io_collected = collect_io;
+			io_uptime = uptime;
 		}
 		//* ---------------------------------------------Collection done-----------------------------------------------
 
+		//* Load deferred names for all processes when the filter or sorting depends on them
+		if ((not filter.empty() and filter_uses_names(filter)) or sorting == "name" or sorting == "command" or sorting == "user") {
+			for (auto& p : shown) load_names(p);
+		}
+
 		//* Match filter if defined
 		if (should_filter) {
 			filter_found = 0;
-			for (auto& p : current_procs) {
+			for (auto& p : shown) {
 				if (not tree and not filter.empty()) {
 					if (!matches_filter(p, filter)) {
 						p.filtered = true;
@@ -2937,17 +4570,19 @@ namespace Proc {
 			}
 		}
 
-		//* Sort processes
-		if (sorted_change or not no_update) {
-			proc_sorter(current_procs, sorting, reverse, tree);
+		//* Sort processes, outside of tree view only the entries down to one page below the visible ones are kept in order
+		static size_t sorted_count{};
+		const size_t sort_limit = (tree ? 0 : Config::getI("proc_start") + Proc::select_max * 2);
+		if (sorted_change or not no_update or min(sort_limit, shown.size()) > sorted_count) {
+			sorted_count = proc_sorter(shown, sorting, reverse, tree, sort_limit);
 		}
 
 		//* Generate tree view if enabled
 		if (tree and (not no_update or should_filter or sorted_change)) {
 			bool locate_selection = false;
 			if (auto find_pid = (collapse != -1 ? collapse : expand); find_pid != -1) {
-				auto collapser = rng::find(current_procs, find_pid, &proc_info::pid);
-				if (collapser != current_procs.end()) {
+				auto collapser = rng::find(shown, find_pid, &proc_info::pid);
+				if (collapser != shown.end()) {
 					if (collapse == expand) {
 						collapser->collapsed = not collapser->collapsed;
 					}
@@ -2963,48 +4598,42 @@ namespace Proc {
 			}
 			if (should_filter or not filter.empty()) filter_found = 0;
 
-			vector<tree_proc> tree_procs;
-			tree_procs.reserve(current_procs.size());
-
-			for (auto& p : current_procs) {
-				if (not v_contains(found, p.ppid)) p.ppid = 0;
-			}
-
-			//? Stable sort to retain selected sorting among processes with the same parent
-			rng::stable_sort(current_procs, rng::less{}, & proc_info::ppid);
-
-			//? Start recursive iteration over processes with the lowest shared parent pids
-			for (auto& p : rng::equal_range(current_procs, current_procs.at(0).ppid, rng::less{}, &proc_info::ppid)) {
-				_tree_gen(p, current_procs, tree_procs, 0, false, filter, false, no_update, should_filter);
+			//? Cgroup rows are always linked to rows of parent cgroups
+			if (not cgroups) {
+				for (auto& p : shown) {
+					if (not rng::binary_search(pids, p.ppid) or (should_filter_kernel and kernels_procs.contains(p.ppid))) p.ppid = 0;
+				}
 			}
 
-			//? Recursive sort over tree structure to account for collapsed processes in the tree
-			int index = 0;
-			tree_sort(tree_procs, sorting, reverse, index, current_procs.size());
-
-			//? Add tree begin symbol to first item if childless
-			if (tree_procs.size() > 0 and tree_procs.front().children.empty() and tree_procs.front().entry.get().prefix.size() >= 8)
-				tree_procs.front().entry.get().prefix.replace(tree_procs.front().entry.get().prefix.size() - 8, 8, " ┌─ ");
-
-			//? Add tree terminator symbol to last item if childless
-			if (tree_procs.size() > 0 and tree_procs.back().children.empty() and tree_procs.back().entry.get().prefix.size() >= 8)
-				tree_procs.back().entry.get().prefix.replace(tree_procs.back().entry.get().prefix.size() - 8, 8, " └─ ");
-
-			//? Final sort based on tree index
-			rng::sort(current_procs, rng::less{}, & proc_info::tree_index);
+			//? Build tree order, filtered out processes and processes in collapsed sub-trees are moved last
+			tree_gen(shown, sorting, reverse, filter, no_update, should_filter);
 
 			//? Move current selection/view to the selected process when collapsing/expanding in the tree
 			if (locate_selection) {
-				int loc = rng::find(current_procs, Proc::selected_pid, &proc_info::pid)->tree_index;
+				int loc = rng::find(shown, Proc::selected_pid, &proc_info::pid)->tree_index;
 				if (Config::ints.at("proc_start") >= loc or Config::ints.at("proc_start") <= loc - Proc::select_max)
 					Config::ints.at("proc_start") = max(0, loc - 1);
 				Config::ints.at("proc_selected") = loc - Config::ints.at("proc_start") + 1;
 			}
 		}
 
-		numpids = (int)current_procs.size() - filter_found;
+		//* Load deferred names for the rows Proc::draw() will show, and for a limited number of other processes in the background
+		const size_t view_start = Config::getI("proc_start");
+		for (size_t n = 0; auto& p : shown) {
+			if (p.filtered or (tree and p.tree_index == shown.size()) or n++ < view_start) continue;
+			if (n > view_start + Proc::select_max) break;
+			load_names(p);
+		}
+		for (size_t budget = names_backfill; auto& p : shown) {
+			if (budget == 0) break;
+			if (not p.names_pending) continue;
+			load_names(p);
+			budget--;
+		}
+
+		numpids = (int)shown.size() - filter_found;
 
-		return current_procs;
+		return shown;
 	}
 }
 
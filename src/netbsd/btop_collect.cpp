@@ -1220,18 +1220,19 @@ namespace Proc {
 						continue;
 					}
 					new_proc.name = kproc->p_comm;
+					string cmd;
 					char** argv = kvm_getargv2(kd.get(), kproc, 0);
 					if (argv) {
-						for (int i = 0; argv[i] and cmp_less(new_proc.cmd.size(), 1000); i++) {
-							new_proc.cmd += argv[i] + " "s;
+						for (int i = 0; argv[i] and cmp_less(cmd.size(), 1000); i++) {
+							cmd += argv[i] + " "s;
 						}
-						if (not new_proc.cmd.empty()) new_proc.cmd.pop_back();
+						if (not cmd.empty()) cmd.pop_back();
 					}
-					if (new_proc.cmd.empty()) new_proc.cmd = new_proc.name;
-					if (new_proc.cmd.size() > 1000) {
-						new_proc.cmd.resize(1000);
-						new_proc.cmd.shrink_to_fit();
+					if (cmd.empty()) cmd = new_proc.name;
+					if (cmd.size() > 1000) {
+						cmd.resize(1000);
 					}
+					new_proc.cmd = cmd;
 					new_proc.ppid = kproc->p_ppid;
 					new_proc.cpu_s = round(kproc->p_ustart_sec);
 					struct passwd *pwd = getpwuid(kproc->p_uid);
@@ -1253,6 +1254,9 @@ namespace Proc {
 				//? Process cumulative cpu usage since process start
 				new_proc.cpu_c = (double)(cpu_t * Shared::clkTck / 1'000'000) / max(1.0, timeNow - new_proc.cpu_s);
 
+				//? Decaying averages of cpu usage
+				update_cpu_avg(new_proc, timeNow);
+
 				//? Update cached value with latest cpu times
 				new_proc.cpu_t = cpu_t;
 
@@ -1327,35 +1331,12 @@ namespace Proc {
 			}
 			if (should_filter or not filter.empty()) filter_found = 0;
 
-			vector<tree_proc> tree_procs;
-			tree_procs.reserve(current_procs.size());
-
 			for (auto& p : current_procs) {
 				if (not v_contains(found, p.ppid)) p.ppid = 0;
 			}
 
-			//? Stable sort to retain selected sorting among processes with the same parent
-			rng::stable_sort(current_procs, rng::less{}, & proc_info::ppid);
-
-			//? Start recursive iteration over processes with the lowest shared parent pids
-			for (auto& p : rng::equal_range(current_procs, current_procs.at(0).ppid, rng::less{}, &proc_info::ppid)) {
-				_tree_gen(p, current_procs, tree_procs, 0, false, filter, false, no_update, should_filter);
-			}
-
-			//? Recursive sort over tree structure to account for collapsed processes in the tree
-			int index = 0;
-			tree_sort(tree_procs, sorting, reverse, index, current_procs.size());
-
-			//? Add tree begin symbol to first item if childless
-			if (tree_procs.front().children.empty())
-				tree_procs.front().entry.get().prefix.replace(tree_procs.front().entry.get().prefix.size() - 8, 8, " ┌─ ");
-
-			//? Add tree terminator symbol to last item if childless
-			if (tree_procs.back().children.empty())
-				tree_procs.back().entry.get().prefix.replace(tree_procs.back().entry.get().prefix.size() - 8, 8, " └─ ");
-
-			//? Final sort based on tree index
-			rng::sort(current_procs, rng::less{}, & proc_info::tree_index);
+			//? Build tree order, filtered out processes and processes in collapsed sub-trees are moved last
+			tree_gen(current_procs, sorting, reverse, filter, no_update, should_filter);
 
 			//? Move current selection/view to the selected process when collapsing/expanding in the tree
 			if (locate_selection) {
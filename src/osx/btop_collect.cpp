@@ -1190,6 +1190,7 @@ namespace Proc {
 							f_name = f_name.substr(lastSlash + 1);
 						}
 						new_proc.name = f_name;
+						string cmd;
 						//? Get process arguments if possible, fallback to process path in case of failure
 						if (Shared::arg_max > 0) {
 							std::unique_ptr<char[]> proc_chars(new char[Shared::arg_max]);
@@ -1201,21 +1202,21 @@ namespace Proc {
 								std::string_view proc_args(proc_chars.get(), argmax);
 								if (size_t null_pos = proc_args.find('\0', sizeof(argc)); null_pos != string::npos) {
 									if (size_t start_pos = proc_args.find_first_not_of('\0', null_pos); start_pos != string::npos) {
-										while (argc-- > 0 and null_pos != string::npos and cmp_less(new_proc.cmd.size(), 1000)) {
+										while (argc-- > 0 and null_pos != string::npos and cmp_less(cmd.size(), 1000)) {
 											null_pos = proc_args.find('\0', start_pos);
-											new_proc.cmd += (string)proc_args.substr(start_pos, null_pos - start_pos) + ' ';
+											cmd += (string)proc_args.substr(start_pos, null_pos - start_pos) + ' ';
 											start_pos = null_pos + 1;
 										}
 									}
 								}
-								if (not new_proc.cmd.empty()) new_proc.cmd.pop_back();
+								if (not cmd.empty()) cmd.pop_back();
 							}
 						}
-						if (new_proc.cmd.empty()) new_proc.cmd = f_name;
-						if (new_proc.cmd.size() > 1000) {
-							new_proc.cmd.resize(1000);
-							new_proc.cmd.shrink_to_fit();
+						if (cmd.empty()) cmd = f_name;
+						if (cmd.size() > 1000) {
+							cmd.resize(1000);
 						}
+						new_proc.cmd = cmd;
 						new_proc.ppid = kproc.kp_eproc.e_ppid;
 						new_proc.cpu_s = kproc.kp_proc.p_starttime.tv_sec * 1'000'000 + kproc.kp_proc.p_starttime.tv_usec;
 						struct passwd *pwd = getpwuid(kproc.kp_eproc.e_ucred.cr_uid);
@@ -1244,6 +1245,9 @@ namespace Proc {
 					//? Process cumulative cpu usage since process start
 					new_proc.cpu_c = (double)(cpu_t * Shared::machTck) / (timeNow - new_proc.cpu_s);
 
+					//? Decaying averages of cpu usage
+					update_cpu_avg(new_proc, timeNow / 1'000'000.0);
+
 					//? Update cached value with latest cpu times
 					new_proc.cpu_t = cpu_t;
 
@@ -1313,35 +1317,12 @@ namespace Proc {
 			}
 			if (should_filter or not filter.empty()) filter_found = 0;
 
-			vector<tree_proc> tree_procs;
-			tree_procs.reserve(current_procs.size());
-
 			for (auto& p : current_procs) {
 				if (not v_contains(found, p.ppid)) p.ppid = 0;
 			}
 
-			//? Stable sort to retain selected sorting among processes with the same parent
-			rng::stable_sort(current_procs, rng::less{}, & proc_info::ppid);
-
-			//? Start recursive iteration over processes with the lowest shared parent pids
-			for (auto& p : rng::equal_range(current_procs, current_procs.at(0).ppid, rng::less{}, &proc_info::ppid)) {
-				_tree_gen(p, current_procs, tree_procs, 0, false, filter, false, no_update, should_filter);
-			}
-
-			//? Recursive sort over tree structure to account for collapsed processes in the tree
-			int index = 0;
-			tree_sort(tree_procs, sorting, reverse, index, current_procs.size());
-
-			//? Add tree begin symbol to first item if childless
-			if (tree_procs.front().children.empty())
-				tree_procs.front().entry.get().prefix.replace(tree_procs.front().entry.get().prefix.size() - 8, 8, " ┌─ ");
-
-			//? Add tree terminator symbol to last item if childless
-			if (tree_procs.back().children.empty())
-				tree_procs.back().entry.get().prefix.replace(tree_procs.back().entry.get().prefix.size() - 8, 8, " └─ ");
-
-			//? Final sort based on tree index
-			rng::sort(current_procs, rng::less{}, & proc_info::tree_index);
+			//? Build tree order, filtered out processes and processes in collapsed sub-trees are moved last
+			tree_gen(current_procs, sorting, reverse, filter, no_update, should_filter);
 
 			//? Move current selection/view to the selected process when collapsing/expanding in the tree
 			if (locate_selection) {